@@ -60,7 +60,10 @@ const char* OSVersionBuild = ".073";
 // #define DISPLAY_YFRAME_AT_LAUNCH
 // #define DISPLAY_ZFRAME_AT_LAUNCH
 // #define DISPLAY_SURFACESCAN_AT_LAUNCH
+// #define DISPLAY_SCANFREQUENCY_AT_LAUNCH
 // #define DISPLAY_FREERAM_AT_LAUNCH
+// #define DISPLAY_PROFILE_AT_LAUNCH
+// #define CAPTURE_TOUCHES_AT_LAUNCH
 // #define TESTING_SENSOR_DISABLE
 
 // Touch surface constants
@@ -111,6 +114,10 @@ byte NUMROWS = 8;                    // number of touch sensor rows
 #define DEFAULT_LED_REFRESH           333
 #define DEFAULT_MIDI_DECIMATION       8000
 #define DEFAULT_MIDI_INTERVAL         235
+#define DEFAULT_MIDI_RUNNING_STATUS   false
+#define DEFAULT_MIDI_RETRIGGER        2000
+#define DEFAULT_MIDI_BATCHED_WRITES   false
+#define DEFAULT_MIDI_INPUT_BUDGET     150
 
 // Differences for low power mode
 // increase the number of call to continuous tasks in low power mode since the leds are refreshed more often
@@ -243,10 +250,22 @@ const unsigned long LED_ARRAY_SIZE = (MAX_LED_LAYERS+1) * LED_LAYER_SIZE;
 #define VELOCITY_SCALE_LOW     43
 #define VELOCITY_SCALE_MEDIUM  41
 #define VELOCITY_SCALE_HIGH    40
+#define VELOCITY_EARLY_SAMPLES 2    // the minimum number of samples for each regression before an early velocity can be sent
+#define VELOCITY_EARLY_BOUND   64   // the maximum difference between the slopes of both regressions for an early velocity
+#define VELOCITY_ONSET_BUCKETS 8    // the number of buckets of the difference between early and final velocities
+
+// Early Velocity Onset Statistics
+// The remaining samples of a touch are still gathered after an early velocity, so each real touch compares the early
+// velocity with the final one. The differences are collected in a histogram with buckets that each double in size,
+// starting with a bucket for no difference at all.
+unsigned long velocityOnsetHistogram[VELOCITY_ONSET_BUCKETS];  // the touches with an early velocity, by difference with the final one
+unsigned long velocityOnsetLateCount = 0;                       // the touches that needed all the samples before the regressions agreed
+unsigned long velocityOnsetSavedTotal = 0;                      // the total time that early velocities were sent before the final ones, in micros
 
 #define DEFAULT_MIN_VELOCITY   1    // default minimum velocity value
 #define DEFAULT_MAX_VELOCITY   127  // default maximum velocity value
 #define DEFAULT_FIXED_VELOCITY 96   // default fixed velocity value
+#define DEFAULT_VELOCITY_ONSET velocityOnsetRegular // default velocity onset, early onset is opt-in
 
 
 /*************************************** CONVENIENCE MACROS **************************************/
@@ -268,6 +287,8 @@ const unsigned long LED_ARRAY_SIZE = (MAX_LED_LAYERS+1) * LED_LAYER_SIZE;
 
 // Current cell in the scan routine
 byte cellCount = 0;                         // the number of the cell that's currently being processed
+byte scanStepCount = 0;                     // counts every cell visit, both for the regular surface scan and for priority visits
+boolean priorityScanVisit = false;          // indicates whether the current cell is a priority visit in between the regular surface scan
 byte sensorCol = 0;                         // currently read column in touch sensor
 byte sensorRow = 0;                         // currently read row in touch sensor
 byte sensorSplit = 0;                       // the split of the currently read touch sensor
@@ -285,7 +306,8 @@ FocusCell focusCell[NUMSPLITS][16];             // 2 splits and 16 MIDI channels
 enum VelocityState {
   velocityCalculating = 0,
   velocityCalculated = 1,
-  velocityNew = 2
+  velocityNew = 2,
+  velocityCorrected = 3
 };
 
 enum TouchState {
@@ -327,6 +349,7 @@ struct __attribute__ ((packed)) TouchInfo {
 #endif
 
   unsigned long lastTouch:32;                // the timestamp when this cell was last touched
+  unsigned long touchStartMoment:32;         // the moment in micros of the first meaningful touch, used to trace the MIDI latency
   short initialX:16;                         // initial calibrated X value of each cell at the start of the touch, INVALID_DATA meaning that it's unassigned
   short initialColumn:16;                    // initial column of each cell at the start of the touch
   short quantizationOffsetX:16;              // quantization offset to be applied to the X value
@@ -390,7 +413,14 @@ VirtualTouchInfo virtualTouchInfo[MAXROWS];  // store as much touch virtual inst
 // Reverse mapping to find the touch information based on the MIDI note and channel,
 // this is used for the arpeggiator to know which notes are active and which cells
 // to look at for continuous velocity calculation
+// only the active notes take an entry, which is looked up through a hash of the note and channel
+#define NOTE_TOUCH_CAPACITY   128     // the maximum number of active notes per split
+#define NOTE_TOUCH_HASH_SIZE  256     // must be a power of two and at least twice the capacity
+#define NOTE_TOUCH_NONE       0xFF    // marks an empty hash bucket
+
 struct NoteEntry {
+  signed char note;
+  signed char channel;
   byte colRow;
   signed char nextNote;
   signed char previousNote;
@@ -421,6 +451,10 @@ struct NoteTouchMapping {
 
   void debugNoteChain();
 
+  inline byte hashNote(signed char, signed char);            // the hash bucket where the lookup of a note and channel starts
+  short findEntry(signed char, signed char);                 // the index in the entries pool of a note and channel, -1 when it's not active
+  void removeEntry(byte);                                    // take an entry out of the hash buckets and the sorted index and return it to the pool
+
   unsigned char split;
   unsigned short noteCount;
   byte musicalTouchCount[16];
@@ -428,7 +462,11 @@ struct NoteTouchMapping {
   signed char firstChannel;
   signed char lastNote;
   signed char lastChannel;
-  NoteEntry mapping[128][16];
+  NoteEntry entries[NOTE_TOUCH_CAPACITY];                    // pool of the entries of the active notes
+  byte freeEntries[NOTE_TOUCH_CAPACITY];                     // stack of the indexes of the unused entries
+  byte freeCount;
+  byte buckets[NOTE_TOUCH_HASH_SIZE];                        // open addressed hash of note and channel to entry index, with linear probing
+  byte sortedEntries[NOTE_TOUCH_CAPACITY];                   // the indexes of the active entries ordered by note, earlier presses of the same note first
 };
 NoteTouchMapping noteTouchMapping[NUMSPLITS];
 
@@ -706,6 +744,11 @@ struct DeviceSettings {
   short lastLoadedPreset;                         // the last settings preset that was loaded
   short lastLoadedProject;                        // the last sequencer project that was loaded
   byte customLeds[LED_PATTERNS][LED_LAYER_SIZE];  // the custom LEDs that persist across power cycle
+  boolean midiRunningStatus;                      // true to leave out repeated channel status bytes when sending over the MIDI jacks
+  unsigned short midiRetriggerUSB;                // the minimum delay between a note off and a note on of the same note and channel when sent over USB
+  unsigned short midiRetriggerDIN;                // the minimum delay between a note off and a note on of the same note and channel when sent over the MIDI jacks
+  boolean midiBatchedWrites;                      // true to write as many MIDI messages at once as the minimum interval between bytes allows
+  unsigned short midiInputBudget;                 // the maximum micros that one call can spend handling received MIDI bytes
 };
 #define Device config.device
 
@@ -717,6 +760,12 @@ enum VelocitySensitivity {
   velocityFixed
 };
 
+enum VelocityOnset {
+  velocityOnsetRegular,
+  velocityOnsetEarly,
+  velocityOnsetEarlyCorrected
+};
+
 // The values here MUST match the row #'s for the leds that get lit up in GlobalSettings
 enum PressureSensitivity {
   pressureLow,
@@ -777,6 +826,7 @@ struct GlobalSettings {
   signed char arpOctave;                     // the number of octaves that the arpeggiator has to operate over: 0, +1, or +2
   SustainBehavior sustainBehavior;           // the way the sustain pedal influences the notes
   boolean splitActive;                       // false = split off, true = split on
+  byte velocityOnset;                        // See VelocityOnset values
 };
 #define Global config.settings.global
 
@@ -874,13 +924,15 @@ struct Configuration config;
 
 /**************************************** SECRET SWITCHES ****************************************/
 
-#define SECRET_SWITCHES 6
+#define SECRET_SWITCHES 8
 #define SWITCH_DEBUGMIDI secretSwitch[0]
 #define SWITCH_XFRAME secretSwitch[1]
 #define SWITCH_YFRAME secretSwitch[2]
 #define SWITCH_ZFRAME secretSwitch[3]
 #define SWITCH_SURFACESCAN secretSwitch[4]
 #define SWITCH_FREERAM secretSwitch[5]
+#define SWITCH_SCANFREQUENCY secretSwitch[6]
+#define SWITCH_PROFILE secretSwitch[7]
 
 boolean secretSwitch[SECRET_SWITCHES];  // The secretSwitch* values are controlled by cells in column 18
 
@@ -984,6 +1036,7 @@ DueFlashStorage dueFlashStorage;                    // access to the persistent
 boolean setupDone = false;                          // indicates whether the setup routine is finished
 
 signed char debugLevel = -1;                        // level of debug messages that should be printed
+boolean captureTouches = false;                     // indicates whether the raw touch samples are streamed to the serial monitor
 boolean firstTimeBoot = false;                      // this will be true when the LinnStrument booted up the first time after a firmware upgrade
 boolean globalReset = false;                        // this will be true when the LinnStrument was just globally reset
 unsigned long lastReset;                            // the last time a reset was started
@@ -1003,9 +1056,91 @@ unsigned long lastControlPress[MAXROWS];
 byte mainLoopDivider = DEFAULT_MAINLOOP_DIVIDER;         // loop divider at which continuous tasks are ran
 unsigned long ledRefreshInterval = DEFAULT_LED_REFRESH;  // LED timing
 unsigned long prevLedTimerCount;                         // timer for refreshing leds
+volatile boolean ledRefreshTimerActive = false;          // indicates whether the LED columns are refreshed by the hardware timer interrupt
+volatile byte ledRefreshCount = 0;                       // incremented for each LED column refresh that's done by the timer interrupt
+volatile boolean ledRefreshPending = false;              // indicates that a timer LED refresh was deferred since the SPI bus was in use
+volatile boolean spiBusy = false;                        // indicates that a touch sensor or ADC transfer is in progress on the SPI bus
 unsigned long prevGlobalSettingsDisplayTimerCount;       // timer for refreshing the global settings display
 unsigned long prevTouchAnimTimerCount;                   // timer for refreshing the touch animation
 
+// Continuous Tasks
+// Each task has a period after which it's due, a deadline for how late it may run after becoming due and a budget
+// for how long a single run is expected to take. The tasks are dispatched in order of priority, which is the order
+// of the table. Once a dispatch has used up its own budget, the tasks that aren't past their deadline are postponed
+// to the next dispatch, so that under load the clock and MIDI tasks keep running while the cosmetic ones wait.
+// A task that is already running is skipped, this replaces the reentrancy guards for nested dispatches from delayUsec.
+// The task budgets are allowances for the work of a single run, as described next to each task in the table, they
+// aren't measured worst cases. The budget overruns of NRPN 390-399 and the CPU profile of NRPN 400-484 show how they
+// hold up. The dispatch budget is the same as the default MIDI input budget, a dispatch that just spent that long on
+// a burst of received MIDI leaves the tasks that aren't late to the next dispatch.
+#define CONTINUOUS_TASKS_BUDGET    DEFAULT_MIDI_INPUT_BUDGET  // micros that a dispatch can spend before postponing tasks that aren't late
+#define CONTINUOUS_TASKS_COSMETIC  1000          // period in micros of the tasks that only affect the display
+#define MIDI_INPUT_TASK_MARGIN     100           // micros that the MIDI input task may run past its byte budget, the budget is only
+                                                 // checked after each byte and the byte that crosses it can complete a message
+
+enum ContinuousTaskId {
+  taskUpdateClock,
+  taskMidiOutput,
+  taskMidiInput,
+  taskRefreshLeds,
+  taskFootSwitches,
+  taskTouchAnimations,
+  taskStopBlinkingLeds,
+  taskLegendDisplayTimeout,
+  taskGlobalSettingsDisplay,
+  taskSleep,
+  CONTINUOUS_TASK_COUNT
+};
+
+struct ContinuousTask {
+  unsigned long period;                          // micros between runs, 0 to run at each dispatch
+  unsigned long deadline;                        // micros that a run can be late before it counts as an overrun
+  unsigned long budget;                          // micros that a single run is expected to take at most
+  boolean running;                               // indicates whether the task is running, to skip it in nested dispatches
+  unsigned long lastRun;                         // the moment in micros the task last started
+  unsigned long deadlineOverruns;                // the number of runs that started later than the deadline
+  unsigned long budgetOverruns;                  // the number of runs that took longer than the budget
+};
+ContinuousTask continuousTasks[CONTINUOUS_TASK_COUNT] = {
+  {0,                         1000,   200},     // taskUpdateClock: the clock check with one arpeggiator and sequencer step, which queue a few notes
+  {0,                         1000,   300},     // taskMidiOutput: one batch of queued messages written to the serial port
+  {0,                         2000,   0},       // taskMidiInput: follows Device.midiInputBudget, see getContinuousTaskBudget
+  {0,                         2000,   100},     // taskRefreshLeds: one LED column over SPI, only when the timer interrupt isn't refreshing them
+  {CONTINUOUS_TASKS_COSMETIC, 10000,  500},     // taskFootSwitches: reading the switches and the action of a change
+  {CONTINUOUS_TASKS_COSMETIC, 20000,  2000},    // taskTouchAnimations: this and the cosmetic tasks below can redraw a part of the display
+  {CONTINUOUS_TASKS_COSMETIC, 50000,  2000},    // taskStopBlinkingLeds
+  {CONTINUOUS_TASKS_COSMETIC, 50000,  2000},    // taskLegendDisplayTimeout
+  {CONTINUOUS_TASKS_COSMETIC, 20000,  2000},    // taskGlobalSettingsDisplay
+  {CONTINUOUS_TASKS_COSMETIC, 100000, 2000}     // taskSleep
+};
+
+// CPU Profiler
+// When active, the cycle counter is read around the touch handling, the sensor reads, each MIDI input byte and each continuous task
+#define PROFILE_BUCKETS 24                       // power of two buckets of cycles for the percentile estimate
+#define PROFILE_NRPN_FIELDS 5                    // the number of NRPN values for each section
+
+enum ProfileSection {
+  profileNewTouch,
+  profileXYZupdate,
+  profileTouchRelease,
+  profileReadX,
+  profileReadY,
+  profileReadZ,
+  profileTasks,                                  // the continuous tasks follow in the order of their table
+  profileMidiInputByte = profileTasks + CONTINUOUS_TASK_COUNT,
+  PROFILE_SECTIONS
+};
+
+struct ProfileStatistics {
+  unsigned long calls;
+  unsigned long minCycles;
+  unsigned long maxCycles;
+  unsigned long long totalCycles;
+  unsigned short histogram[PROFILE_BUCKETS];     // calls per power of two of cycles, halved when one saturates
+};
+ProfileStatistics profileStatistics[PROFILE_SECTIONS];
+boolean profilerActive = false;                  // indicates whether the cycles of the profiled sections are counted
+
 boolean customLedPatternActive = false;                  // was a custom led pattern loaded from flash
 
 unsigned long tempoLedOn = 0;                       // indicates when the tempo clock led was turned on
@@ -1042,12 +1177,29 @@ boolean stopAnimation = false;                      // indicates whether animati
 
 int32_t fxd4CurrentTempo = FXD4_FROM_INT(120);               // the current tempo
 unsigned long midiDecimateRate = DEFAULT_MIDI_DECIMATION;    // default MIDI decimation rate
+unsigned long midiDecimateMinimum = DEFAULT_MIDI_DECIMATION; // the finest MIDI decimation rate the adaptation can use
+unsigned long midiDecimateMaximum = DEFAULT_MIDI_DECIMATION; // the coarsest MIDI decimation rate the adaptation can use
+boolean midiDecimateAdaptive = true;                         // indicates whether the MIDI decimation rate adapts to the MIDI output backlog
 unsigned long midiMinimumInterval = DEFAULT_MIDI_INTERVAL;   // minimum interval between sending two MIDI bytes
-byte lastValueMidiNotesOn[NUMSPLITS][128][16];               // for each split, keep track of MIDI note on to filter out note off messages that are not needed
+unsigned long midiRetriggerInterval = DEFAULT_MIDI_RETRIGGER; // minimum interval between a note off and a note on of the same note and channel
 int32_t fxdPitchHoldSamples[NUMSPLITS];                      // for each split the actual pitch hold duration in samples
 int32_t fxdRateXThreshold[NUMSPLITS];                        // the threshold below which the average rate of change of X is considered 'stationary' and pitch hold quantization will start to occur
 int latestNoteNumberForAutoOctave = -1;                      // keep track of the latest note number that was generated to use for auto octave switching
 
+// For each split, keep track of MIDI note on to filter out note off messages that are not needed.
+// A bit is set for each note and channel that is on, the rare note that is turned on several times without
+// being turned off takes an entry in the stacked notes pool that counts the additional note ons.
+#define MIDI_STACKED_NOTES 16
+
+struct StackedMidiNote {
+  byte split;
+  byte note;
+  byte channel;
+  byte count;                                                // the number of note ons beyond the first, 0 when the entry is unused
+};
+unsigned long midiNotesOn[NUMSPLITS][16][4];                 // per split and channel, a 128-bit bitmap of the notes that are on
+StackedMidiNote stackedMidiNotes[MIDI_STACKED_NOTES];
+
 byte audienceMessageToEdit = 0;                     // the audience message to edit with that mode is active
 short audienceMessageOffset = 0;                    // the offset in columns for printing the edited audience message
 short audienceMessageLength = 0;                    // the length in pixels of the audience message to edit
@@ -1058,9 +1210,19 @@ int32_t fxdLimitsForZRatio[NUMSPLITS];              // the ratio to convert the
 int32_t fxdMinVelOffset;                            // the offset to apply to the velocity values
 int32_t fxdVelRatio;                                // the ratio to convert the full range of velocity into the range applied by the limits
 
+struct SensorRangesZ {
+  unsigned short sensorRange;                       // the usable range of the raw Z values above the lowest acceptable Z value
+  unsigned short velocityRange;                     // the range of the raw Z values for velocity, based on the velocity sensitivity
+  unsigned short pressureRange;                     // the range of the raw Z values for pressure, based on the pressure sensitivity and aftertouch
+  short pressureOffset;                             // the raw Z values to skip before pressure starts, used for pressure aftertouch
+  int32_t fxdVelocityRatio;                         // the ratio to scale the velocity range to the maximum sensor range
+  int32_t fxdPressureRatio;                         // the ratio to scale the pressure range to the maximum sensor range
+};
+SensorRangesZ sensorRangesZ;                        // the Z processing ranges derived from the settings, updated by applySensorRangesZ()
+
 byte limitsForYConfigState = 1;                     // the last state of the Y value limit configuration, this counts down to go to further pages
 byte limitsForZConfigState = 2;                     // the last state of the Z value limit configuration, this counts down to go to further pages
-byte limitsForVelocityConfigState = 1;              // the last state of the velocity value limit configuration, this counts down to go to further pages
+byte limitsForVelocityConfigState = 2;              // the last state of the velocity value limit configuration, this counts down to go to further pages
 byte lowRowCCXConfigState = 1;                      // the last state of the advanced low row CCX configuration, this counts down to go to further pages
 byte lowRowCCXYZConfigState = 3;                    // the last state of the advanced low row CCXYZ configuration, this counts down to go to further pages
 byte sleepConfigState = 1;                          // the last state of the sleep configuration, this counts down to go to further pages
@@ -1071,6 +1233,8 @@ unsigned long projectBlinkStart[MAX_PROJECTS];      // the moments at which the
 boolean controlModeActive = false;                  // indicates whether control mode is active, detecting no expression but very sensitive cell presses intended for fast typing
 
 unsigned long lastTouchMoment = 0;                  // last time someone touched LinnStrument in milliseconds
+unsigned long midiLatencyOrigin = 0;                // the moment in micros of the touch sample that's being handled, 0 when queued MIDI isn't caused by a touch
+unsigned long midiNoteOnLatencyOrigin = 0;          // the moment in micros of the first meaningful touch that's being handled, for note on messages
 
 unsigned short clock24PPQ = 0;                      // the current clock in 24PPQ, either internal or synced to incoming MIDI clock
 
@@ -1177,9 +1341,11 @@ void applyMidiInterval() {
   if (isMidiUsingDIN()) {
     // 256 microseconds between bytes on Serial ports
     midiMinimumInterval = 256;
+    midiRetriggerInterval = Device.midiRetriggerDIN;
   }
   else {
     midiMinimumInterval = Device.minUSBMIDIInterval;
+    midiRetriggerInterval = Device.midiRetriggerUSB;
   }
 
   if (Device.operatingLowPower && midiMinimumInterval < LOWPOWER_MIDI_INTERVAL) {
@@ -1191,12 +1357,19 @@ void applyMidiInterval() {
 
 void applyMidiDecimationRate() {
   // this is just a number made up with lots of testing in order to avoid having
-  // too many MIDI messages backing up in the outgoing queue
+  // too many MIDI messages backing up in the outgoing queue, it's now the starting
+  // point from which the rate adapts to the actual backlog of MIDI messages
   midiDecimateRate = midiMinimumInterval * 34;
+  midiDecimateMinimum = midiMinimumInterval * 8;
+  midiDecimateMaximum = midiMinimumInterval * 136;
 
-  if (Device.operatingLowPower && midiDecimateRate < LOWPOWER_MIDI_DECIMATION) {
-    midiDecimateRate = LOWPOWER_MIDI_DECIMATION;
+  if (Device.operatingLowPower) {
+    midiDecimateRate = max(midiDecimateRate, (unsigned long)LOWPOWER_MIDI_DECIMATION);
+    midiDecimateMinimum = max(midiDecimateMinimum, (unsigned long)LOWPOWER_MIDI_DECIMATION);
+    midiDecimateMaximum = max(midiDecimateMaximum, (unsigned long)LOWPOWER_MIDI_DECIMATION);
   }
+
+  midiDecimateAdaptive = true;
 }
 
 void applyMpeMode() {
@@ -1335,6 +1508,7 @@ void setup() {
     Global.maxForVelocity = 127;
     applyLimitsForVelocity();
     Global.pressureSensitivity = pressureLow;
+    applySensorRangesZ();
 
     // Disable serial mode
     Device.serialMode = false;
@@ -1394,12 +1568,33 @@ void setup() {
   SWITCH_SURFACESCAN = true;
 #endif
 
+#ifdef DISPLAY_SCANFREQUENCY_AT_LAUNCH
+  #define DEBUG_ENABLED
+  Device.serialMode = true;
+  SWITCH_SCANFREQUENCY = true;
+#endif
+
 #ifdef DISPLAY_FREERAM_AT_LAUNCH
   #define DEBUG_ENABLED
   Device.serialMode = true;
   SWITCH_FREERAM = true;
 #endif
 
+#ifdef DISPLAY_PROFILE_AT_LAUNCH
+  #define DEBUG_ENABLED
+  Device.serialMode = true;
+  SWITCH_PROFILE = true;
+#endif
+
+#ifdef CAPTURE_TOUCHES_AT_LAUNCH
+  #define DEBUG_ENABLED
+  Device.serialMode = true;
+  captureTouches = true;
+#endif
+
+  // from now on the LED columns are refreshed in the background by a hardware timer
+  initializeLedRefreshTimer();
+
   setupDone = true;
 
   applySerialMode();
@@ -1447,15 +1642,32 @@ inline void modeLoopPerformance() {
 
     if (previousTouch != touchedCell && previousTouch != ignoredCell &&
         sensorCell->isMeaningfulTouch()) {                                       // if touched now but not before, it's a new touch
+      sensorCell->touchStartMoment = micros();
+      midiLatencyOrigin = midiNoteOnLatencyOrigin = sensorCell->touchStartMoment;
+      unsigned long profileStart = beginProfile();
       canShortCircuit = handleNewTouch();
+      endProfile(profileNewTouch, profileStart);
     }
     else if (previousTouch == touchedCell && sensorCell->isActiveTouch()) {      // if touched now and touched before
+      midiLatencyOrigin = micros();
+      midiNoteOnLatencyOrigin = sensorCell->touchStartMoment;
+      unsigned long profileStart = beginProfile();
       canShortCircuit = handleXYZupdate();                                       // handle any X, Y or Z movements
+      endProfile(profileXYZupdate, profileStart);
     }
     else if (previousTouch != untouchedCell && !sensorCell->isActiveTouch() &&   // if not touched now but touched before, it's been released
              sensorCell->isPastDebounceDelay()) {
+        midiLatencyOrigin = micros();
+        midiNoteOnLatencyOrigin = 0;
+        unsigned long profileStart = beginProfile();
         handleTouchRelease();
+        endProfile(profileTouchRelease, profileStart);
     }
+    midiLatencyOrigin = 0;                                                       // MIDI messages that are queued from now on are not caused by this touch
+
+#ifdef DEBUG_ENABLED
+    if (captureTouches) captureTouchSample(previousTouch);                       // stream the raw samples of this cell, including the ones that are short-circuited
+#endif
 
     if (canShortCircuit) {
       sensorCell->shouldRefreshData();                                           // immediately process this cell again without going through a full surface scan
@@ -1463,6 +1675,18 @@ inline void modeLoopPerformance() {
     }
   }
 
+#ifdef DEBUG_ENABLED
+  if (SWITCH_XFRAME) displayXFrame();                            // Turn on secret switch to display the X value of all cells in grid at the end of each total surface scan
+  if (SWITCH_YFRAME) displayYFrame();                            // Turn on secret switch to display the Y value of all cells in grid at the end of each total surface scan
+  if (SWITCH_ZFRAME) displayZFrame();                            // Turn on secret switch to display the pressure value of all cells in grid at the end of each total surface scan
+  if (SWITCH_SURFACESCAN) displaySurfaceScanTime();              // Turn on secret switch to display the total time for a total surface scan and the cell revisit intervals
+  if (SWITCH_SCANFREQUENCY) displayScanFrequency();              // Turn on secret switch to display the achieved surface scan and cell read frequencies
+  if (SWITCH_FREERAM) debugFreeRam();                            // Turn on secret switch to display the available free RAM
+  if (SWITCH_PROFILE) displayProfile();                          // Turn on secret switch to display the CPU profile of the touch handling, sensor reads and continuous tasks
+#endif
+
+  nextSensorCell();                                              // done-- move on to the next sensor cell, this already selects its analog switches
+
   // When operating in low power mode, slow down the sensor scan rate in order to consume less power
   // This introduces an overall additional average latency of 2.5ms
   if (Device.operatingLowPower) {
@@ -1473,17 +1697,9 @@ inline void modeLoopPerformance() {
   // at each sensor cell, only call this every three cells.
   // Note that this is very much dependent on the speed of the main loop, if it slows down
   // lights will start flickering and this ratio might have to be adapted.
-  if (cellCount % mainLoopDivider == 0) {
+  // These tasks are performed after the next sensor cell has been selected, so that the
+  // analog switches are settling while they're running.
+  if (scanStepCount % mainLoopDivider == 0) {
     performContinuousTasks();
   }
-
-#ifdef DEBUG_ENABLED
-  if (SWITCH_XFRAME) displayXFrame();                            // Turn on secret switch to display the X value of all cells in grid at the end of each total surface scan
-  if (SWITCH_YFRAME) displayYFrame();                            // Turn on secret switch to display the Y value of all cells in grid at the end of each total surface scan
-  if (SWITCH_ZFRAME) displayZFrame();                            // Turn on secret switch to display the pressure value of all cells in grid at the end of each total surface scan
-  if (SWITCH_SURFACESCAN) displaySurfaceScanTime();              // Turn on secret switch to display the total time for a total surface scan
-  if (SWITCH_FREERAM) debugFreeRam();                            // Turn on secret switch to display the available free RAM
-#endif
-
-  nextSensorCell();                                              // done-- move on to the next sensor cell
 }
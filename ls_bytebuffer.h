@@ -16,9 +16,13 @@ limitations under the License.
 Circular byte buffer that has independent push and pop locations. This allows a fixed memory usage
 for a queue of data, without having to worry about memory allocation.
 
-Once the size of the buffer fills up though, new data will start filling the beginning back up
-again. You need to be careful to select the approriate size of the byte buffer for your use-case
-in order to prevent losing data.
+Once the size of the buffer fills up though, the overflow policy decides what happens to new data:
+- byteBufferOverwrite makes new data overwrite the oldest unread data, as the buffer always did
+- byteBufferReject drops the new bytes that don't fit
+- byteBufferDropRecord also drops single bytes that don't fit, but pushRecord drops the whole record
+  so that the framing of the data in the buffer is never broken
+The buffer keeps track of its high-water mark and of the number of bytes that were dropped, so that
+you can select the appropriate size of the byte buffer for your use-case.
 **************************************************************************************************/
 
 #ifndef BYTEBUFFER_H_
@@ -26,29 +30,100 @@ in order to prevent losing data.
 
 #include <Arduino.h>
 
-template <unsigned int Size>
+enum ByteBufferPolicy {
+  byteBufferOverwrite,
+  byteBufferReject,
+  byteBufferDropRecord
+};
+
+template <unsigned int Size, ByteBufferPolicy Policy = byteBufferOverwrite>
 class ByteBuffer {
 public:
-  ByteBuffer() : write_(buffer_), read_(buffer_), tail_(buffer_+Size) {}
+  ByteBuffer() : write_(buffer_), read_(buffer_), tail_(buffer_+Size), size_(0), highWaterMark_(0), dropped_(0) {}
   ~ByteBuffer() {}
 
-  void push(byte value) {
+  boolean push(byte value) {
+    if (size_ == Size) {
+      dropped_++;
+      if (Policy != byteBufferOverwrite) {
+        return false;
+      }
+      // make room by discarding the oldest unread byte
+      pop();
+    }
+
     *write_++ = value;
     if (write_ == tail_) write_ = buffer_;
+    size_++;
+    if (size_ > highWaterMark_) highWaterMark_ = size_;
+    return true;
+  }
+
+  boolean pushRecord(const byte* values, unsigned int length) {
+    if (Policy == byteBufferDropRecord && length > free()) {
+      dropped_ += length;
+      return false;
+    }
+
+    boolean result = true;
+    for (unsigned int i = 0; i < length; ++i) {
+      result &= push(values[i]);
+    }
+    return result;
+  }
+
+  // drop:
+  // Accounts for data that the producer dropped itself since it knew it wouldn't fit
+  void drop(unsigned int length) {
+    dropped_ += length;
   }
 
   byte peek() {
     return *read_;
   }
 
+  byte peek(unsigned int offset) {
+    byte* position = read_ + offset;
+    if (position >= tail_) position -= Size;
+    return *position;
+  }
+
   byte pop() {
+    if (size_ == 0) return 0;
+
     byte result = *read_++;
     if (read_ == tail_) read_ = buffer_;
+    size_--;
     return result;
   }
 
   boolean empty() const {
-    return write_ == read_;
+    return size_ == 0;
+  }
+
+  unsigned int size() const {
+    return size_;
+  }
+
+  unsigned int capacity() const {
+    return Size;
+  }
+
+  unsigned int free() const {
+    return Size - size_;
+  }
+
+  unsigned int highWaterMark() const {
+    return highWaterMark_;
+  }
+
+  unsigned long dropped() const {
+    return dropped_;
+  }
+
+  void resetStatistics() {
+    highWaterMark_ = size_;
+    dropped_ = 0;
   }
 
 private:
@@ -56,6 +131,9 @@ private:
   byte* write_;
   byte* read_;
   byte* tail_;
+  unsigned int size_;
+  unsigned int highWaterMark_;
+  unsigned long dropped_;
 };
 
 #endif
@@ -43,6 +43,36 @@ const short CALY_DEFAULT_MAX[MAXROWS] = {473, 991, 1486, 1965, 2449, 2925, 3401,
 // only use a portion of the Y distance, since the fingers can't comfortably reach until the real edges
 const byte CALY_MARGIN_FRACTION = 4;
 
+// the X calibration of each cell is precomputed into a slope and an offset with twice the fixed point precision,
+// these interpolate between the calibration rows so that calibrating a raw X value becomes a single multiply-add
+#define CALX_COEFFICIENT_FBITS  (2 * FXD_FBITS)
+
+struct CalibrationXCell {
+  int32_t slope;
+  int32_t offset;
+};
+CalibrationXCell calCellsX[MAXCOLS][MAXROWS];
+
+// the Y calibration of each calibration column cell is precomputed into a reciprocal of its ratio, together with
+// the left and right calibration columns and their blend weights for each sensor column, this avoids any division
+#define CALY_DIVIDEND_BITS  28
+
+struct CalibrationYCell {
+  unsigned short minY;
+  unsigned short maxY;
+  uint32_t reciprocal;
+  byte shift;
+};
+CalibrationYCell calCellsY[9][MAXROWS];
+
+struct CalibrationYBlend {
+  byte left;
+  byte right;
+  int32_t fxdLeftWeight;
+  int32_t fxdRightWeight;
+};
+CalibrationYBlend calBlendY[MAXCOLS];
+
 void initializeCalibration() {
   if (LINNMODEL == 200) {
     CALROWNUM = 4;
@@ -146,30 +176,85 @@ void initializeCalibrationData() {
       Device.calCols[col][row].fxdRatio = FXD_DIV(FXD_FROM_INT(Device.calCols[col][row].maxY - Device.calCols[col][row].minY), FXD_CALY_FULL_UNIT);
     }
   }
+
+  precomputeCalibrationData();
 }
 
-short calculateCalibratedX(short rawX) {
-  int32_t fxdRawX = FXD_FROM_INT(rawX);
+void precomputeCalibrationData() {
+  for (byte col = 0; col < NUMCOLS; ++col) {
+    for (byte row = 0; row < NUMROWS; ++row) {
+      byte sector = (row / 3);
+      byte sectorTop = sector + 1;
+
+      byte bottomRow = 0;
+      byte topRow = 2;
+      switch (sector) {
+        case 0: bottomRow = 0; topRow = 2; break;
+        case 1: bottomRow = 2; topRow = 5; break;
+        case 2: bottomRow = 5; topRow = 7; break;
+      }
 
-  byte sector = (sensorRow / 3);
-  byte sectorTop = sector + 1;
+      // The calibrated X position of a sector row is referenceX + (rawX - measuredX) * ratio, which is rewritten
+      // as rawX * slope + offset for both the bottom and the top sector rows of this column
+      CalibrationX& bottom = Device.calRows[col][sector];
+      CalibrationX& top = Device.calRows[col][sectorTop];
+      int64_t bottomSlope = (int64_t)bottom.fxdRatio << FXD_FBITS;
+      int64_t bottomOffset = ((int64_t)bottom.fxdReferenceX << FXD_FBITS) - (int64_t)bottom.fxdMeasuredX * bottom.fxdRatio;
+      int64_t topSlope = (int64_t)top.fxdRatio << FXD_FBITS;
+      int64_t topOffset = ((int64_t)top.fxdReferenceX << FXD_FBITS) - (int64_t)top.fxdMeasuredX * top.fxdRatio;
+
+      // Interpolate the slope and the offset between the bottom and the top sector rows based on this row
+      calCellsX[col][row].slope = bottomSlope + (topSlope - bottomSlope) * (row - bottomRow) / (topRow - bottomRow);
+      calCellsX[col][row].offset = bottomOffset + (topOffset - bottomOffset) * (row - bottomRow) / (topRow - bottomRow);
+    }
+  }
 
-  byte bottomRow = 0;
-  byte topRow = 2;
-  switch (sector) {
-    case 0: bottomRow = 0; topRow = 2; break;
-    case 1: bottomRow = 2; topRow = 5; break;
-    case 2: bottomRow = 5; topRow = 7; break;
+  for (byte col = 0; col < 9; ++col) {
+    for (byte row = 0; row < NUMROWS; ++row) {
+      CalibrationYCell& cell = calCellsY[col][row];
+      cell.minY = Device.calCols[col][row].minY;
+      cell.maxY = Device.calCols[col][row].maxY;
+
+      // The dividend of the ratio division always fits in 28 bits, picking the shift as 28 bits plus the bit length
+      // of the ratio and rounding the reciprocal up makes the multiplication give the exact same results as the division
+      int32_t fxdRatio = Device.calCols[col][row].fxdRatio;
+      if (fxdRatio <= 0 || cell.maxY < cell.minY) {
+        cell.reciprocal = 0;
+        cell.shift = 0;
+      }
+      else {
+        byte ratioBits = 0;
+        while (((uint32_t)1 << ratioBits) < (uint32_t)fxdRatio) {
+          ratioBits++;
+        }
+        cell.shift = CALY_DIVIDEND_BITS + ratioBits;
+        cell.reciprocal = (((uint64_t)1 << cell.shift) + fxdRatio - 1) / fxdRatio;
+      }
+    }
   }
 
-  // We calculate the calibrated X position for the bottom sector row for the current sensor column
-  int32_t fxdBottomX = Device.calRows[sensorCol][sector].fxdReferenceX + FXD_MUL(fxdRawX - Device.calRows[sensorCol][sector].fxdMeasuredX, Device.calRows[sensorCol][sector].fxdRatio);
+  for (byte col = 0; col < NUMCOLS; ++col) {
+    byte calCol = (col - 1) / 3;
+    byte bias = (col - 1) % 3;
+    calBlendY[col].left = calCol;
+    calBlendY[col].fxdLeftWeight = FXD_DIV(FXD_CONST_3 - FXD_FROM_INT(bias), FXD_CONST_3);
+    if (calCol < 8) {
+      calBlendY[col].right = calCol + 1;
+      calBlendY[col].fxdRightWeight = FXD_DIV(FXD_FROM_INT(bias), FXD_CONST_3);
+    }
+    else {
+      calBlendY[col].right = calCol;
+      calBlendY[col].fxdRightWeight = 0;
+    }
+  }
+}
 
-  // We calculate the calibrated X position for the top sector row for the current sensor column
-  int32_t fxdTopX = Device.calRows[sensorCol][sectorTop].fxdReferenceX + FXD_MUL(fxdRawX - Device.calRows[sensorCol][sectorTop].fxdMeasuredX, Device.calRows[sensorCol][sectorTop].fxdRatio);
+short calculateCalibratedX(short rawX) {
+  CalibrationXCell& cell = calCellsX[sensorCol][sensorRow];
 
-  // The final calibrated X position is the interpolation between the bottom and the top sector rows based on the current sensor row
-  int result = FXD_TO_INT(fxdBottomX + FXD_MUL(FXD_DIV(fxdTopX - fxdBottomX, FXD_FROM_INT(topRow - bottomRow)), FXD_FROM_INT(sensorRow - bottomRow)));
+  // The calibrated X position is interpolated between the sector rows of the current sensor column,
+  // this has been precomputed for each cell with precomputeCalibrationData()
+  int result = (rawX * cell.slope + cell.offset + (1 << (CALX_COEFFICIENT_FBITS - 1))) >> CALX_COEFFICIENT_FBITS;
 
   // constrain the calibrated X position to have a full 4095 range between the centers of the left and right cells,
   // but still have values for the remaining left and right halves
@@ -178,9 +263,34 @@ short calculateCalibratedX(short rawX) {
   return result;
 }
 
+inline int32_t calculateCalibratedColumnY(CalibrationYCell& cell, short rawY) {
+  uint32_t fxdDividend = FXD_FROM_INT(FXD_FROM_INT(constrain(rawY, cell.minY, cell.maxY) - cell.minY));
+  return ((uint64_t)fxdDividend * cell.reciprocal) >> cell.shift;
+}
+
+signed char calculateCalibratedY(byte col, byte row, short rawY) {
+  CalibrationYBlend& blend = calBlendY[col];
+
+  int32_t fxdLeftY = calculateCalibratedColumnY(calCellsY[blend.left][row], rawY);
+  int32_t fxdRightY = calculateCalibratedColumnY(calCellsY[blend.right][row], rawY);
+
+  int result = FXD_TO_INT(FXD_MUL(fxdLeftY, blend.fxdLeftWeight) + FXD_MUL(fxdRightY, blend.fxdRightWeight));
+
+  // Bound the Y position to accepted value limits 
+  result = constrain(result, 0, 127);
+
+  return result;
+}
+
 signed char calculateCalibratedY(short rawY) {
-  byte col = (sensorCol - 1) / 3;
-  byte row = sensorRow;
+  return calculateCalibratedY(sensorCol, sensorRow, rawY);
+}
+
+#ifdef DEBUG_ENABLED
+// This is the original Y calibration that divides by the calibration ratios, it's only used to verify the precomputed calibration
+signed char calculateDividedCalibratedY(byte cellCol, byte cellRow, short rawY) {
+  byte col = (cellCol - 1) / 3;
+  byte row = cellRow;
 
   int32_t fxdLeftY = FXD_DIV(FXD_FROM_INT(constrain(rawY, Device.calCols[col][row].minY, Device.calCols[col][row].maxY) - Device.calCols[col][row].minY), Device.calCols[col][row].fxdRatio);
   int32_t fxdRightY = 0;
@@ -188,7 +298,7 @@ signed char calculateCalibratedY(short rawY) {
     fxdRightY = FXD_DIV(FXD_FROM_INT(constrain(rawY, Device.calCols[col+1][row].minY, Device.calCols[col+1][row].maxY) - Device.calCols[col+1][row].minY), Device.calCols[col+1][row].fxdRatio);
   }
 
-  byte bias = (sensorCol - 1) % 3;
+  byte bias = (cellCol - 1) % 3;
   int result = FXD_TO_INT(FXD_MUL(fxdLeftY, FXD_DIV(FXD_CONST_3 - FXD_FROM_INT(bias), FXD_CONST_3)) +
                           FXD_MUL(fxdRightY, FXD_DIV(FXD_FROM_INT(bias), FXD_CONST_3)));
 
@@ -198,6 +308,31 @@ signed char calculateCalibratedY(short rawY) {
   return result;
 }
 
+// countCalibratedYMismatches:
+// Compares the precomputed Y calibration with the original one over the full 12-bit raw range of every playable cell,
+// the first mismatch is printed and the number of mismatches is returned
+unsigned long countCalibratedYMismatches() {
+  unsigned long mismatches = 0;
+  for (byte col = 1; col < NUMCOLS; ++col) {
+    for (byte row = 0; row < NUMROWS; ++row) {
+      for (short rawY = 0; rawY <= 4095; ++rawY) {
+        if (calculateCalibratedY(col, row, rawY) != calculateDividedCalibratedY(col, row, rawY)) {
+          if (mismatches == 0) {
+            DEBUGPRINT((0,"calibratedY mismatch"));
+            DEBUGPRINT((0," col="));DEBUGPRINT((0,(int)col));
+            DEBUGPRINT((0," row="));DEBUGPRINT((0,(int)row));
+            DEBUGPRINT((0," rawY="));DEBUGPRINT((0,(int)rawY));
+            DEBUGPRINT((0,"\n"));
+          }
+          mismatches++;
+        }
+      }
+    }
+  }
+  return mismatches;
+}
+#endif
+
 boolean handleCalibrationSample() {
   // calibrate the X value distribution by measuring the minimum and maximum for each cell
   if (displayMode == displayCalibration) {
@@ -572,6 +707,8 @@ boolean handleCalibrationRelease() {
           Device.calibrated = true;
           Device.calibrationHealed = false;
 
+          precomputeCalibrationData();
+
 #ifdef DEBUG_ENABLED
           debugCalibration();
 #endif
@@ -642,4 +779,10 @@ void debugCalibration() {
       DEBUGPRINT((0,"\n"));
     }
   }
+
+#ifdef DEBUG_ENABLED
+  unsigned long mismatches = countCalibratedYMismatches();
+  DEBUGPRINT((0,"calibratedY mismatches="));DEBUGPRINT((0,(int)mismatches));
+  DEBUGPRINT((0,"\n"));
+#endif
 }
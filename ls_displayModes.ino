@@ -81,7 +81,13 @@ void setDisplayMode(DisplayMode mode) {
     exitDisplayMode(displayMode);
   }
 
+  // the pressure range is fixed while calibrating the sensor sensitivity
+  boolean sensorRangesChanged = (refresh && (displayMode == displaySensorSensitivityZ || mode == displaySensorSensitivityZ));
+
   displayMode = mode;
+  if (sensorRangesChanged) {
+    applySensorRangesZ();
+  }
   if (refresh) {
     enterDisplayMode(mode);
     completelyRefreshLeds();
@@ -1267,14 +1273,27 @@ void paintLimitsForVelocityDisplay() {
   clearDisplay();
 
   switch (limitsForVelocityConfigState) {
-    case 1:
+    case 2:
       condfont_draw_string(0, 0, "L", globalColor, true);
       paintNumericDataDisplay(globalColor, Global.minForVelocity, 4, true);
       break;
-    case 0:
+    case 1:
       condfont_draw_string(0, 0, "H", globalColor, true);
       paintNumericDataDisplay(globalColor, Global.maxForVelocity, 4, true);
       break;
+    case 0:
+      switch (Global.velocityOnset) {
+        case velocityOnsetRegular:
+          adaptfont_draw_string(0, 0, "REG", globalColor, true);
+          break;
+        case velocityOnsetEarly:
+          adaptfont_draw_string(0, 0, "EARL", globalColor, true);
+          break;
+        case velocityOnsetEarlyCorrected:
+          adaptfont_draw_string(0, 0, "ECOR", globalColor, true);
+          break;
+      }
+      break;
   }
 }
 
@@ -881,8 +881,35 @@ struct SplitSettingsV7 {
   boolean sequencer;                      // true when the sequencer of this split is displayed
   SequencerView sequencerView;            // see SequencerView
 };
+struct GlobalSettingsV10 {
+  byte splitPoint;                           // leftmost column number of right split (0 = leftmost column of playable area)
+  byte currentPerSplit;                      // controls which split's settings are being displayed
+  byte activeNotes;                          // controls which collection of note lights presets is active
+  int mainNotes[12];                         // bitmask array that determines which notes receive "main" lights
+  int accentNotes[12];                       // bitmask array that determines which notes receive accent lights (octaves, white keys, black keys, etc.)
+  byte rowOffset;                            // interval between rows. 0 = no overlap, 1-12 = interval, 13 = guitar
+  signed char customRowOffset;               // the custom row offset that can be configured at the location of the octave setting
+  byte guitarTuning[MAXROWS];                // the notes used for each row for the guitar tuning, 0-127
+  VelocitySensitivity velocitySensitivity;   // See VelocitySensitivity values
+  unsigned short minForVelocity;             // 1-127
+  unsigned short maxForVelocity;             // 1-127
+  unsigned short valueForFixedVelocity;      // 1-127
+  PressureSensitivity pressureSensitivity;   // See PressureSensitivity values
+  boolean pressureAftertouch;                // Indicates whether pressure should behave like traditional piano keyboard aftertouch or be continuous from the start
+  byte switchAssignment[5];                  // The element values are ASSIGNED_*.  The index values are SWITCH_*.
+  boolean switchBothSplits[5];               // Indicate whether the switches should operate on both splits or only on the focused one
+  unsigned short ccForSwitchCC65[5];         // 0-127
+  unsigned short ccForSwitchSustain[5];      // 0-127
+  unsigned short customSwitchAssignment[5];  // ASSIGNED_TAP_TEMPO, ASSIGNED_LEGATO, ASSIGNED_LATCH, ASSIGNED_PRESET_UP, ASSIGNED_PRESET_DOWN, ASSIGNED_REVERSE_PITCH_X, ASSIGNED_SEQUENCER_PLAY, ASSIGNED_SEQUENCER_PREV, ASSIGNED_SEQUENCER_NEXT, ASSIGNED_STANDALONE_MIDI_CLOCK and ASSIGNED_SEQUENCER_MUTE
+  byte midiIO;                               // 0 = MIDI jacks, 1 = USB
+  ArpeggiatorDirection arpDirection;         // the arpeggiator direction that has to be used for the note sequence
+  ArpeggiatorStepTempo arpTempo;             // the multiplier that needs to be applied to the current tempo to achieve the arpeggiator's step duration
+  signed char arpOctave;                     // the number of octaves that the arpeggiator has to operate over: 0, +1, or +2
+  SustainBehavior sustainBehavior;           // the way the sustain pedal influences the notes
+  boolean splitActive;                       // false = split off, true = split on
+};
 struct PresetSettingsV11 {
-  GlobalSettings global;
+  GlobalSettingsV10 global;
   SplitSettingsV7 split[NUMSPLITS];
 };
 struct ConfigurationV15 {
@@ -894,12 +921,52 @@ struct ConfigurationV15 {
 /**************************************** Configuration V16 ****************************************
 This is used by firmware v2.3.0, v2.3.1, v2.3.2, v2.3.3
 **************************************************************************************************/
+struct DeviceSettingsV13 {
+  byte version;                                   // the version of the configuration format
+  boolean serialMode;                             // 0 = normal MIDI I/O, 1 = Arduino serial mode for OS update and serial monitor
+  CalibrationX calRows[MAXCOLS+1][4];             // store four rows of calibration data
+  CalibrationY calCols[9][MAXROWS];               // store nine columns of calibration data
+  uint32_t calCrc;                                // the CRC check value of the calibration data to see if it's still valid
+  boolean calCrcCalculated;                       // indicates whether the CRC of the calibration was calculated, previous firmware versions didn't
+  boolean calibrated;                             // indicates whether the calibration data actually resulted from a calibration operation
+  boolean calibrationHealed;                      // indicates whether the calibration data was healed
+  unsigned short minUSBMIDIInterval;              // the minimum delay between MIDI bytes when sent over USB
+  byte sensorSensitivityZ;                        // the scaling factor of the raw value of Z in percentage
+  unsigned short sensorLoZ;                       // the lowest acceptable raw Z value to start a touch
+  unsigned short sensorFeatherZ;                  // the lowest acceptable raw Z value to continue a touch
+  unsigned short sensorRangeZ;                    // the maximum raw value of Z
+  boolean sleepAnimationActive;                   // store whether an animation was active last
+  boolean sleepActive;                            // store whether LinnStrument should go to sleep automatically
+  byte sleepDelay;                                // the number of minutes it takes for sleep to kick in
+  byte sleepAnimationType;                        // the animation type to use during sleep, see SleepAnimationType
+  char audienceMessages[16][31];                  // the 16 audience messages that will scroll across the surface
+  boolean operatingLowPower;                      // whether low power mode is active or not
+  boolean otherHanded;                            // whether change the handedness of the splits
+  byte splitHandedness;                           // see SplitHandednessType
+  boolean midiThrough;                            // false if incoming MIDI should be isolated, true if it should be passed through to the outgoing MIDI port
+  short lastLoadedPreset;                         // the last settings preset that was loaded
+  short lastLoadedProject;                        // the last sequencer project that was loaded
+  byte customLeds[LED_PATTERNS][LED_LAYER_SIZE];  // the custom LEDs that persist across power cycle
+};
 struct ConfigurationV16 {
-  DeviceSettings device;
+  DeviceSettingsV13 device;
   PresetSettingsV11 settings;
   PresetSettingsV11 preset[NUMPRESETS];
   SequencerProject project;
 };
+/**************************************** Configuration V17 ****************************************
+This is used by firmware v2.3.4
+**************************************************************************************************/
+struct PresetSettingsV12 {
+  GlobalSettingsV10 global;
+  SplitSettings split[NUMSPLITS];
+};
+struct ConfigurationV17 {
+  DeviceSettingsV13 device;
+  PresetSettingsV12 settings;
+  PresetSettingsV12 preset[NUMPRESETS];
+  SequencerProject project;
+};
 /*************************************************************************************************/
 
 boolean upgradeConfigurationSettings(int32_t confSize, byte* buff2) {
@@ -1014,6 +1081,12 @@ boolean upgradeConfigurationSettings(int32_t confSize, byte* buff2) {
         break;
       // this is the v17 of the configuration configuration, apply it if the size is right
       case 17:
+        if (confSize == sizeof(ConfigurationV17)) {
+          copyConfigurationFunction = &copyConfigurationV17;
+        }
+        break;
+      // this is the v18 of the configuration configuration, apply it if the size is right
+      case 18:
         if (confSize == sizeof(Configuration)) {
           memcpy(&config, buff2, confSize);
           result = true;
@@ -2253,11 +2326,43 @@ void copySplitSettingsV7(void* target, void* source) {
   t->sequencerView = s->sequencerView;
 }
 
+void copyGlobalSettingsV10(void* target, void* source) {
+  GlobalSettings* t = (GlobalSettings*)target;
+  GlobalSettingsV10* s = (GlobalSettingsV10*)source;
+
+  t->splitPoint = s->splitPoint;
+  t->currentPerSplit = s->currentPerSplit;
+  t->activeNotes = s->activeNotes;
+  memcpy(t->mainNotes, s->mainNotes, sizeof(int)*12);
+  memcpy(t->accentNotes, s->accentNotes, sizeof(int)*12);
+  t->rowOffset = s->rowOffset;
+  t->customRowOffset = s->customRowOffset;
+  memcpy(t->guitarTuning, s->guitarTuning, sizeof(byte)*MAXROWS);
+  t->velocitySensitivity = s->velocitySensitivity;
+  t->minForVelocity = s->minForVelocity;
+  t->maxForVelocity = s->maxForVelocity;
+  t->valueForFixedVelocity = s->valueForFixedVelocity;
+  t->pressureSensitivity = s->pressureSensitivity;
+  t->pressureAftertouch = s->pressureAftertouch;
+  memcpy(t->switchAssignment, s->switchAssignment, sizeof(byte)*5);
+  memcpy(t->switchBothSplits, s->switchBothSplits, sizeof(boolean)*5);
+  memcpy(t->ccForSwitchCC65, s->ccForSwitchCC65, sizeof(unsigned short)*5);
+  memcpy(t->ccForSwitchSustain, s->ccForSwitchSustain, sizeof(unsigned short)*5);
+  memcpy(t->customSwitchAssignment, s->customSwitchAssignment, sizeof(unsigned short)*5);
+  t->midiIO = s->midiIO;
+  t->arpDirection = s->arpDirection;
+  t->arpTempo = s->arpTempo;
+  t->arpOctave = s->arpOctave;
+  t->sustainBehavior = s->sustainBehavior;
+  t->splitActive = s->splitActive;
+  t->velocityOnset = DEFAULT_VELOCITY_ONSET;
+}
+
 void copyPresetSettingsV11(void* target, void* source) {
   PresetSettings* t = (PresetSettings*)target;
   PresetSettingsV11* s = (PresetSettingsV11*)source;
 
-  memcpy(&t->global, &s->global, sizeof(GlobalSettings));
+  copyGlobalSettingsV10(&t->global, &s->global);
 
   copySplitSettingsV7(&t->split[LEFT], &s->split[LEFT]);
   copySplitSettingsV7(&t->split[RIGHT], &s->split[RIGHT]);
@@ -2283,7 +2388,7 @@ void copyConfigurationV16(void* target, void* source) {
   Configuration* t = (Configuration*)target;
   ConfigurationV16* s = (ConfigurationV16*)source;
 
-  memcpy(&t->device, &s->device, sizeof(DeviceSettings));
+  copyDeviceSettingsV13(&t->device, &s->device);
 
   copyPresetSettingsV11(&t->settings, &s->settings);
   for (byte p = 0; p < 6; ++p) {
@@ -2292,3 +2397,65 @@ void copyConfigurationV16(void* target, void* source) {
 
   memcpy(&t->project, &s->project, sizeof(SequencerProject));
 }
+
+/*************************************************************************************************/
+
+void copyPresetSettingsV12(void* target, void* source) {
+  PresetSettings* t = (PresetSettings*)target;
+  PresetSettingsV12* s = (PresetSettingsV12*)source;
+
+  copyGlobalSettingsV10(&t->global, &s->global);
+
+  memcpy(&t->split[LEFT], &s->split[LEFT], sizeof(SplitSettings));
+  memcpy(&t->split[RIGHT], &s->split[RIGHT], sizeof(SplitSettings));
+}
+
+void copyConfigurationV17(void* target, void* source) {
+  Configuration* t = (Configuration*)target;
+  ConfigurationV17* s = (ConfigurationV17*)source;
+
+  copyDeviceSettingsV13(&t->device, &s->device);
+
+  copyPresetSettingsV12(&t->settings, &s->settings);
+  for (byte p = 0; p < NUMPRESETS; ++p) {
+    copyPresetSettingsV12(&t->preset[p], &s->preset[p]);
+  }
+
+  memcpy(&t->project, &s->project, sizeof(SequencerProject));
+}
+
+void copyDeviceSettingsV13(void* target, void* source) {
+  DeviceSettings* t = (DeviceSettings*)target;
+  DeviceSettingsV13* s = (DeviceSettingsV13*)source;
+
+  t->version = s->version;
+  t->serialMode = s->serialMode;
+  memcpy(&(t->calRows), &(s->calRows), sizeof(t->calRows));
+  memcpy(&(t->calCols), &(s->calCols), sizeof(t->calCols));
+  t->calCrc = s->calCrc;
+  t->calCrcCalculated = s->calCrcCalculated;
+  t->calibrated = s->calibrated;
+  t->calibrationHealed = s->calibrationHealed;
+  t->minUSBMIDIInterval = s->minUSBMIDIInterval;
+  t->sensorSensitivityZ = s->sensorSensitivityZ;
+  t->sensorLoZ = s->sensorLoZ;
+  t->sensorFeatherZ = s->sensorFeatherZ;
+  t->sensorRangeZ = s->sensorRangeZ;
+  t->sleepAnimationActive = s->sleepAnimationActive;
+  t->sleepActive = s->sleepActive;
+  t->sleepDelay = s->sleepDelay;
+  t->sleepAnimationType = s->sleepAnimationType;
+  memcpy(&(t->audienceMessages), &(s->audienceMessages), sizeof(t->audienceMessages));
+  t->operatingLowPower = s->operatingLowPower;
+  t->otherHanded = s->otherHanded;
+  t->splitHandedness = s->splitHandedness;
+  t->midiThrough = s->midiThrough;
+  t->lastLoadedPreset = s->lastLoadedPreset;
+  t->lastLoadedProject = s->lastLoadedProject;
+  memcpy(&(t->customLeds), &(s->customLeds), sizeof(t->customLeds));
+  t->midiRunningStatus = DEFAULT_MIDI_RUNNING_STATUS;
+  t->midiRetriggerUSB = DEFAULT_MIDI_RETRIGGER;
+  t->midiRetriggerDIN = DEFAULT_MIDI_RETRIGGER;
+  t->midiBatchedWrites = DEFAULT_MIDI_BATCHED_WRITES;
+  t->midiInputBudget = DEFAULT_MIDI_INPUT_BUDGET;
+}
@@ -777,6 +777,13 @@ boolean handleXYZupdate() {
       newVelocity = true;
       break;
 
+    case velocityCorrected:
+      // the note was sent with an early velocity that turned out to be different from the final one
+      if (Global.velocityOnset == velocityOnsetEarlyCorrected) {
+        sendVelocityCorrection();
+      }
+      break;
+
     case velocityCalculated:
       // velocity has been calculated, no need to short-circuit anymore and we can continue
       // with the main touch logic
@@ -1064,7 +1071,19 @@ boolean handleXYZupdate() {
     }
   }
 
-  return false;
+  // when the note was sent with an early velocity, keep short-circuiting until the final velocity is known
+  return sensorCell->isCalculatingVelocity();
+}
+
+// Send the final velocity of a note that was started with an early velocity as polyphonic aftertouch,
+// unless poly pressure is already used to send the Z expression of the touches in this split
+void sendVelocityCorrection() {
+  if (userFirmwareActive || !sensorCell->hasNote() ||
+      (Split[sensorSplit].sendZ && Split[sensorSplit].expressionForZ == loudnessPolyPressure)) {
+    return;
+  }
+
+  midiSendPolyPressure(sensorCell->note, sensorCell->velocity, sensorCell->channel);
 }
 
 void handleSplitStrum() {
@@ -1431,12 +1450,18 @@ short handleXExpression() {
        sensorCell->currentRawZ > (Device.sensorLoZ + SENSOR_PITCH_Z)) &&  // when there are multiple touches in the same column, reduce the pitch bend Z sensitivity to prevent unwanted pitch slides
       sensorCell->hasUsableX()) {                                         // if no phantom presses are active, send the pitch bend change, otherwise only send those changes that are small and gradual to prevent rogue pitch sweeps
 
-    // calculate the average rate of X value changes over a number of samples
-    sensorCell->fxdRateX -= FXD_DIV(sensorCell->fxdRateX, fxdRateXSamples);
-    sensorCell->fxdRateX += FXD_DIV(FXD_FROM_INT(deltaX), fxdRateXSamples);
+    // the rate of X changes and the pitch hold duration are counted in samples of the regular surface scan,
+    // priority visits in between don't contribute to them
+    boolean regularSample = !priorityScanVisit;
 
-    // remember the last X movement
-    sensorCell->lastMovedX = movedX;
+    if (regularSample) {
+      // calculate the average rate of X value changes over a number of samples
+      sensorCell->fxdRateX -= FXD_DIV(sensorCell->fxdRateX, fxdRateXSamples);
+      sensorCell->fxdRateX += FXD_DIV(FXD_FROM_INT(deltaX), fxdRateXSamples);
+
+      // remember the last X movement
+      sensorCell->lastMovedX = movedX;
+    }
 
     // if pitch quantize on hold is disabled, just output the current touch pitch
     if (!doQuantizeHold()) {
@@ -1456,7 +1481,7 @@ short handleXExpression() {
     }
 
     // keep track of how many times the X changement rate drops below the threshold or above
-    if (fxdRateXThreshold[sensorSplit] >= sensorCell->fxdRateX) {
+    if (regularSample && fxdRateXThreshold[sensorSplit] >= sensorCell->fxdRateX) {
       if (sensorCell->fxdRateCountX < fxdPitchHoldSamples[sensorSplit]) {
         sensorCell->fxdRateCountX += FXD_CONST_1;
 
@@ -1471,7 +1496,7 @@ short handleXExpression() {
         }
       }
     }
-    else if (sensorCell->fxdRateCountX > 0) {
+    else if (regularSample && sensorCell->fxdRateCountX > 0) {
       if (sensorCell->fxdRateCountX > 0) {
         sensorCell->fxdRateCountX -= FXD_CONST_1;
       }
@@ -1850,9 +1875,6 @@ void handleOpenStringsRelease() {
   }
 }
 
-// nextSensorCell:
-// Moves on to the next cell witin the total surface scan of all surface cells.
-
 #define MAX_CELLCOUNT 201
 byte CELLCOUNT = MAX_CELLCOUNT;
 byte SCANNED_CELLS[MAX_CELLCOUNT][2];
@@ -1902,8 +1924,77 @@ void initializeTouchHandling() {
   }
 }
 
+// Touched cells and their direct neighbours are visited again in between the regular surface scan,
+// after every PRIORITY_SCAN_INTERVAL regular cells, so every third scan step is a priority visit.
+// This gives active touches several X/Y/Z updates during each full surface scan, while the regular
+// scan of idle cells is at most slowed down by a third, which guarantees that new touches are still
+// detected in time. The velocity samples of a new touch are read in a short-circuited burst on the
+// same cell, priority visits can't come in between them. The pitch hold samples only count regular
+// visits, see handleXExpression.
+#define PRIORITY_SCAN_INTERVAL 2
+
+byte priorityScanCol = 0;                   // the column that is currently being visited by the priority scan
+byte priorityScanRows = 0;                  // bitmask of the rows in that column that still need a priority visit
+
+// getPriorityRowsInCol:
+// Returns a bitmask with the rows of a column that are touched or that are adjacent to a touched cell.
+inline byte getPriorityRowsInCol(byte col) {
+  int32_t rows = rowsInColsTouched[col];
+  rows |= (rows << 1) | (rows >> 1);
+  if (col > 1) {
+    rows |= rowsInColsTouched[col - 1];
+  }
+  if (col < NUMCOLS - 1) {
+    rows |= rowsInColsTouched[col + 1];
+  }
+  return rows & ((1 << NUMROWS) - 1);
+}
+
+// nextPriorityCell:
+// Selects the next touched or neighbouring cell in round-robin, returns false when there's none.
+inline boolean nextPriorityCell() {
+  if (cellsTouched == 0) {
+    priorityScanRows = 0;
+    return false;
+  }
+
+  // the control switches in column 0 don't need priority visits
+  for (byte i = 0; i < NUMCOLS && priorityScanRows == 0; ++i) {
+    if (++priorityScanCol >= NUMCOLS) {
+      priorityScanCol = 1;
+    }
+    priorityScanRows = getPriorityRowsInCol(priorityScanCol);
+  }
+
+  if (priorityScanRows == 0) {
+    return false;
+  }
+
+  byte row = 31 - __builtin_clz(priorityScanRows);
+  priorityScanRows &= ~(1 << row);
+
+  sensorCol = priorityScanCol;
+  sensorRow = row;
+  return true;
+}
+
+// nextSensorCell:
+// Moves on to the next cell witin the total surface scan of all surface cells, interleaved with priority visits.
 inline void nextSensorCell() {
   static byte controlRow = 0;
+  static byte regularScanCount = 0;
+
+  ++scanStepCount;
+
+  priorityScanVisit = false;
+  if (++regularScanCount > PRIORITY_SCAN_INTERVAL) {
+    regularScanCount = 0;
+    if (nextPriorityCell()) {
+      priorityScanVisit = true;
+      updateSensorCell();
+      return;
+    }
+  }
 
   sensorCol = SCANNED_CELLS[cellCount][0];
   sensorRow = SCANNED_CELLS[cellCount][1];
@@ -1928,6 +2019,8 @@ inline void updateSensorCell() {
   sensorCell = &cell(sensorCol, sensorRow);
   // we're keeping track of the state of X, Y and Z so that we don't refresh it needlessly for finger tracking
   sensorCell->shouldRefreshData();
+  // start settling the analog switches for the Z read of this cell while other tasks are performed
+  prepareSensorCell(sensorCol, sensorRow, READ_Z);
 }
 
 
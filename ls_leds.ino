@@ -56,6 +56,19 @@ byte bufferedLeds = 0;
 
 bool ledDisplayEnabled = true;
 
+// The visible combined layer is also maintained as per-column bitplanes that are already in the format that's sent
+// to the LED driver chips, this way refreshing a column doesn't have to decode each individual cell anymore
+#define LED_PLANE_FULL     0                    // bitplane with the colors as they are
+#define LED_PLANE_REDUCED  1                    // bitplane with the composite colors reduced, used to modulate their brightness
+byte ledPlanes[MAXCOLS][2][3];                  // for each column and plane, the blue, green and red bits of each row
+byte ledPulseRows[MAXCOLS][3];                  // for each column, the rows with a fast, slow and focus pulse
+
+// the blue (bit 0), green (bit 1) and red (bit 2) components of each color, in full and in reduced form
+const byte LED_COLOR_COMPONENTS[2][COLOR_PINK + 1] = {
+  { B000, B100, B110, B010, B011, B001, B101, B000, B111, B100, B110, B101 },
+  { B000, B100, B110, B010, B011, B001, B101, B000, B011, B110, B010, B110 }
+};
+
 void initializeLeds() {
   if (LINNMODEL == 200) {
     for (byte i = 0; i < MAXCOLS; ++i) {
@@ -71,6 +84,9 @@ void initializeLeds() {
 
 void initializeLedLayers() {
   memset(leds[bufferedLeds], 0, LED_ARRAY_SIZE);
+  if (bufferedLeds == visibleLeds) {
+    refreshAllLedPlanes();
+  }
 }
 
 void initializeLedsLayer(byte layer) {
@@ -133,6 +149,53 @@ void startBufferedLeds() {
 void finishBufferedLeds() {
   memcpy(leds[visibleLeds], leds[bufferedLeds], LED_ARRAY_SIZE);
   bufferedLeds = 0;
+  refreshAllLedPlanes();
+}
+
+// updateLedPlanes:
+// Updates the bitplanes of a single cell from the visible combined layer. The LED timer interrupt reads the bitplanes
+// of a column at any time, so the new bits are prepared first and stored with the interrupts disabled, this way a
+// column is never shown with a cell that's only partly updated.
+void updateLedPlanes(byte col, byte row) {
+  byte color = (ledVisible(LED_LAYER_COMBINED, col, row) & B11111000) >> 3;
+  byte cellDisplay = ledVisible(LED_LAYER_COMBINED, col, row) & B00000111;
+  if (cellDisplay == cellOff || color > COLOR_PINK) {
+    color = COLOR_OFF;
+  }
+
+  byte rowBit = B00000001 << row;
+
+  byte planeBits[2][3];
+  for (byte plane = LED_PLANE_FULL; plane <= LED_PLANE_REDUCED; ++plane) {
+    byte components = LED_COLOR_COMPONENTS[plane][color];
+    for (byte c = 0; c < 3; ++c) {
+      planeBits[plane][c] = (components & (B00000001 << c)) ? rowBit : 0;
+    }
+  }
+
+  byte pulseBits[3];
+  for (byte p = 0; p < 3; ++p) {
+    pulseBits[p] = (cellDisplay == cellFastPulse + p) ? rowBit : 0;
+  }
+
+  noInterrupts();
+  for (byte plane = LED_PLANE_FULL; plane <= LED_PLANE_REDUCED; ++plane) {
+    for (byte c = 0; c < 3; ++c) {
+      ledPlanes[col][plane][c] = (ledPlanes[col][plane][c] & ~rowBit) | planeBits[plane][c];
+    }
+  }
+  for (byte p = 0; p < 3; ++p) {
+    ledPulseRows[col][p] = (ledPulseRows[col][p] & ~rowBit) | pulseBits[p];
+  }
+  interrupts();
+}
+
+void refreshAllLedPlanes() {
+  for (byte col = 0; col < NUMCOLS; ++col) {
+    for (byte row = 0; row < NUMROWS; ++row) {
+      updateLedPlanes(col, row);
+    }
+  }
 }
 
 inline byte getCombinedLedData(byte col, byte row) {
@@ -184,6 +247,9 @@ void setLed(byte col, byte row, byte color, CellDisplay disp, byte layer) {
   if (ledBuffered(layer, col, row) != data) {
     ledBuffered(layer, col, row) = data;
     ledBuffered(LED_LAYER_COMBINED, col, row) = getCombinedLedData(col, row);
+    if (bufferedLeds == visibleLeds) {
+      updateLedPlanes(col, row);
+    }
   }
 
   if (bufferedLeds == 1) {
@@ -245,6 +311,9 @@ void completelyRefreshLeds() {
   for (byte row = 0; row < NUMROWS; ++row) {
     for (byte col = 0; col < NUMCOLS; ++col) {
       ledBuffered(LED_LAYER_COMBINED, col, row) = getCombinedLedData(col, row);
+      if (bufferedLeds == visibleLeds) {
+        updateLedPlanes(col, row);
+      }
     }
     performContinuousTasks();
   }
@@ -297,115 +366,40 @@ void refreshLedColumn(unsigned long now) {
   }
 
   static byte ledCol = 0;
-  static byte displayInterval[MAXCOLS][MAXROWS];
+  static byte displayPhase = 0;
 
-  byte red = 0;                                           // red value to be sent
-  byte green = 0;                                         // green value to be sent
-  byte blue = 0;                                          // blue value to be sent
-  byte actualCol = 0;                                     // actual column being refreshed, permitting columns to be lit non-sequentially by using COL_INDEX[] array
-  byte ledColShifted = 0;                                 // LED column address, which is shifted 2 bits to left within byte
+  byte actualCol = COL_INDEX[ledCol];                      // using COL_INDEX[], permits non-sequential lighting of LED columns, which doesn't seem to improve appearance
+  byte ledColShifted = 0;                                  // LED column address, which is shifted 2 bits to left within byte
 
-  actualCol = COL_INDEX[ledCol];                           // using COL_INDEX[], permits non-sequential lighting of LED columns, which doesn't seem to improve appearance
-
-   // Initialize bytes to send to LEDs over SPI. Each bit represents a single LED on or off
-  for (byte rowCount = 0; rowCount < NUMROWS; ++rowCount) {       // step through the 8 rows
-    // allow several levels of brightness by modulating LED's ON time
-    if (++displayInterval[actualCol][rowCount] >= 12) {
-      displayInterval[actualCol][rowCount] = 0;
+  // allow several levels of brightness by modulating LED's ON time, composite colors alternate with their reduced form
+  byte plane = LED_PLANE_FULL;
+  byte rowsOn = B11111111;
+  if (Device.operatingLowPower) {
+    if (displayPhase % 2 != 0) {
+      rowsOn = 0;
     }
-
-    byte color = (ledVisible(LED_LAYER_COMBINED, actualCol, rowCount) & B11111000) >> 3;    // set temp value 'color' to 4 color bits of this LED within array
-    byte cellDisplay = ledVisible(LED_LAYER_COMBINED, actualCol, rowCount) & B00000111;     // get cell display value
-
-    switch (cellDisplay) {
-      case cellFastPulse:
-        cellDisplay = lastPulseOn ? cellOn : cellOff;
-        break;
-      case cellSlowPulse:
-        cellDisplay = lastSlowPulseOn ? cellOn : cellOff;
-        break;
-      case cellFocusPulse:
-        cellDisplay = lastFocusPulseOn ? cellOn : cellOff;
-        break;
+    else if (displayPhase % 4 != 0) {
+      plane = LED_PLANE_REDUCED;
     }
+  }
+  else if (displayPhase % 2 != 0) {
+    plane = LED_PLANE_REDUCED;
+  }
 
-    if (Device.operatingLowPower) {
-      if (displayInterval[actualCol][rowCount] % 2 != 0) {
-        cellDisplay = cellOff;
-      }
-    }
+  // turn off the pulsing LEDs that are in their off phase
+  if (!lastPulseOn) rowsOn &= ~ledPulseRows[actualCol][0];
+  if (!lastSlowPulseOn) rowsOn &= ~ledPulseRows[actualCol][1];
+  if (!lastFocusPulseOn) rowsOn &= ~ledPulseRows[actualCol][2];
 
-    // if this LED is not off, process it
-    // set the color bytes to the correct color
-    if (cellDisplay) {
-      // construct composite colors
-      if ((!Device.operatingLowPower && displayInterval[actualCol][rowCount] % 2 != 0) ||
-          (Device.operatingLowPower && displayInterval[actualCol][rowCount] % 4 != 0)) {
-        switch (color)
-        {
-          case COLOR_WHITE:
-            color = COLOR_CYAN;
-            break;
-          case COLOR_ORANGE:
-            color = COLOR_YELLOW;
-            break;
-          case COLOR_LIME:
-            color = COLOR_GREEN;
-            break;
-          case COLOR_PINK:
-            color = COLOR_YELLOW;
-            break;
-        }
-      }
+  byte blue = ledPlanes[actualCol][plane][0] & rowsOn;     // blue value to be sent
+  byte green = ledPlanes[actualCol][plane][1] & rowsOn;    // green value to be sent
+  byte red = ledPlanes[actualCol][plane][2] & rowsOn;      // red value to be sent
 
-      switch (color)
-      {
-        case COLOR_OFF:
-        case COLOR_BLACK:
-          break;
-        case COLOR_RED:
-          red = red | (B00000001 << rowCount);
-          break;
-        case COLOR_YELLOW:
-          red = red | (B00000001 << rowCount);
-          green = green | (B00000001 << rowCount);
-          break;
-        case COLOR_GREEN:
-          green = green | (B00000001 << rowCount);
-          break;
-        case COLOR_CYAN:
-          green = green | (B00000001 << rowCount);
-          blue = blue | (B00000001 << rowCount);
-          break;
-        case COLOR_BLUE:
-          blue = blue | (B00000001 << rowCount);
-          break;
-        case COLOR_MAGENTA:
-          blue = blue | (B00000001 << rowCount);
-          red = red | (B00000001 << rowCount);
-          break;
-        case COLOR_WHITE:
-          blue = blue | (B00000001 << rowCount);
-          red = red | (B00000001 << rowCount);
-          green = green | (B00000001 << rowCount);
-          break;
-        case COLOR_ORANGE:
-          red = red | (B00000001 << rowCount);
-          break;
-        case COLOR_LIME:
-          red = red | (B00000001 << rowCount);
-          green = green | (B00000001 << rowCount);
-          break;
-        case COLOR_PINK:
-          blue = blue | (B00000001 << rowCount);
-          red = red | (B00000001 << rowCount);
-          break;
-      }
-    }
+  if (++ledCol >= NUMCOLS) {
+    ledCol = 0;
+    if (++displayPhase >= 4) displayPhase = 0;
   }
 
-  if (++ledCol >= NUMCOLS) ledCol = 0;
-
   ledColShifted = actualCol << 2;
   if ((actualCol & 16) == 0) ledColShifted |= B10000000;          // if column address 4 is 0, set bit 7
 
@@ -21,6 +21,15 @@ These are the MIDI functions for the LinnStrument
 
 #define MAX_SYSEX_LENGTH 256
 
+#define MIDI_DIN_BYTE_MICROS 320                           // the time it takes to transmit one byte at 31250 baud
+
+// SysEx LED Frame
+// F0 7D 4C 53 01 <layer> <col> <row> <width> <height> <cells...> F7
+// Uses the non-commercial manufacturer ID followed by 'L' 'S' and the command, each cell is a single byte with the
+// color in the lower four bits and the cell display in the upper three, row by row from the bottom left of the frame.
+#define SYSEX_LED_FRAME_HEADER  9
+#define SYSEX_LED_FRAME_COMMAND 0x01
+
 // first byte is the status byte, the two following bytes are the data bytes and
 // the channel will be encoded in the 4th byte if applicable
 byte midiMessage[4];
@@ -30,8 +39,108 @@ byte midiMessageIndex = 0; // the message array index of the message that is bei
 byte midiCellColCC = 0;
 byte midiCellRowCC = 0;
 
-ByteBuffer<4096> midiOutQueue;
-ByteBuffer<MAX_SYSEX_LENGTH * 2> sysexOutQueue;
+// the last part of the queue is kept for note offs, a full queue then never leaves a note hanging
+#define MIDI_NOTE_OFF_RESERVE 256
+
+ByteBuffer<4096, byteBufferDropRecord> midiOutQueue;
+ByteBuffer<MAX_SYSEX_LENGTH * 2, byteBufferDropRecord> sysexOutQueue;
+
+// Continuous MIDI Output
+// Pitch bend, control change, channel pressure and poly pressure are coalesced in a slot per channel and
+// controller, only the latest value of each slot waits to be sent. The waiting slots are entries of a small pool
+// that are linked in the order in which they started waiting, each channel has a bitmask of its entries. The
+// waiting slots of a channel are sent right before its next note on or note off, the others are sent when no
+// ordered messages are left in midiOutQueue and after every streak of MIDI_ORDERED_STREAK ordered messages.
+#define MIDI_SLOTS_CC            0                         // slot numbers of 16 channels of 128 controllers
+#define MIDI_SLOTS_PP            2048                      // 16 channels of 128 notes
+#define MIDI_SLOTS_PB            4096                      // 16 channels
+#define MIDI_SLOTS_AT            4112                      // 16 channels
+#define MIDI_SLOTS_COUNT         4128                      // also used for messages that don't have a slot
+#define MIDI_WAITING_SLOTS       64                        // the number of slots that can wait at the same time, at most 64
+#define MIDI_WAITING_NONE        0xFF
+#define MIDI_WAITING_ROTATIONS   4                         // number of waiting slots that are examined for each message
+#define MIDI_ORDERED_STREAK      4                         // number of ordered messages after which a due waiting slot gets a turn
+
+struct MidiWaitingSlot {
+  unsigned short slot;                                     // the slot number that is waiting
+  unsigned short order;                                    // the moment the slot started waiting, in number of waiting slots
+  byte value;                                              // the latest value of the slot, the LSB for pitch bend
+  byte msb;                                                // the latest MSB for pitch bend
+  byte previous;                                           // the entries that waited before and after this one, MIDI_WAITING_NONE at the ends
+  byte next;
+};
+MidiWaitingSlot midiWaitingSlots[MIDI_WAITING_SLOTS];
+unsigned long long midiWaitingUsed = 0;                    // bitmask of the entries of midiWaitingSlots that are in use
+unsigned long long midiChannelWaiting[16];                 // for each channel, bitmask of its waiting entries
+byte midiWaitingFirst = MIDI_WAITING_NONE;                 // the entry that has been waiting the longest
+byte midiWaitingLast = MIDI_WAITING_NONE;                  // the entry that started waiting most recently
+byte midiWaitingCount = 0;
+unsigned short midiWaitingOrder = 0;
+
+// MIDI Decimation Control
+// Every period, the decimation rate is adapted to the backlog of MIDI messages and the rate at which they were sent.
+// This keeps the backlog around the target latency, with finer resolution when the link is idle and coarser
+// continuous data under heavy load.
+#define MIDI_DECIMATION_PERIOD          10000              // adapt the decimation rate every 10 ms
+#define MIDI_DECIMATION_TARGET_LATENCY  3000               // aim for a backlog that takes about 3 ms to send
+#define MIDI_DECIMATION_MINIMUM_STEP    100                // the smallest increase of the decimation rate, in micros
+
+unsigned long midiOutSentMessages = 0;                     // the number of MIDI messages that were written to the serial port
+unsigned short midiOutHighWaterMark = 0;                   // the largest backlog of MIDI messages that was measured
+
+// MIDI Output Batching
+// In batched mode, each call to handlePendingMidi writes as many messages at once as the minimum interval between
+// bytes allows since the previous write, up to MIDI_BATCH_BYTES. The time that was left unused while the output was
+// idle only counts for MIDI_BATCH_CREDIT bytes, so that bursts after short idle gaps stay close to the average interval.
+#define MIDI_BATCH_BYTES  32
+#define MIDI_BATCH_CREDIT 12                               // about four messages
+
+// MIDI Running Status
+// When sending over the MIDI jacks, a channel status byte that is the same as the previous one can be left out.
+// Real-time messages don't affect the running status, system common messages and SysEx cancel it.
+#define MIDI_RUNNING_STATUS_REFRESH 1000000                // repeat the status byte after a second so that a receiver that was connected since can pick up the stream
+
+byte midiOutRunningStatus = 0;                             // the status byte that is currently running, 0 when the next one has to be sent
+unsigned long midiOutRunningStatusMoment = 0;              // the moment the running status byte was last sent
+unsigned long midiOutWrittenBytes = 0;                     // the number of MIDI message bytes that were written to the serial port
+unsigned long midiOutOmittedBytes = 0;                     // the number of status bytes that were left out thanks to running status
+
+// MIDI Note Retrigger Pacing
+// Some receivers mishandle a note on that closely follows the note off of the same note and channel. Such a note on
+// is held back until midiRetriggerInterval has passed since the note off was sent, other data can go out meanwhile.
+#define MIDI_NOTE_OFF_HISTORY 8
+
+struct MidiNoteOffMoment {
+  boolean active;                                          // indicates whether this note off can still hold back a note on
+  byte channel;
+  byte note;
+  unsigned long moment;                                    // the moment in micros the note off was sent
+};
+
+MidiNoteOffMoment midiNoteOffHistory[MIDI_NOTE_OFF_HISTORY];
+byte midiNoteOffHistoryIndex = 0;
+
+// Held note ons wait aside from midiOutQueue so that the messages behind them can go ahead. A note off of
+// the same note that arrives meanwhile is attached to the held note on and sent right after it.
+#define MIDI_HELD_NOTE_ONS 8
+#define MIDI_SLOTS_HELD    (MIDI_SLOTS_COUNT + 1)          // latency trace slots of the held note ons and of their note offs, two per entry
+
+struct MidiHeldNoteOn {
+  boolean active;                                          // indicates whether this entry is in use
+  boolean noteOnSent;                                      // indicates whether the note on was sent and only the note off is left
+  boolean noteOffPending;                                  // indicates whether the note off of the same note is waiting behind it
+  byte channel;
+  byte note;
+  byte velocity;
+  byte noteOffType;                                        // MIDINoteOff, or MIDINoteOn for a note off with velocity 0
+  byte noteOffVelocity;
+  unsigned long since;                                     // the moment in micros the note on was held back
+};
+
+MidiHeldNoteOn midiHeldNoteOns[MIDI_HELD_NOTE_ONS];
+byte midiHeldNoteOnCount = 0;
+unsigned long midiRetriggerDelayCount = 0;                 // the number of note ons that were held back
+unsigned long midiRetriggerDelayTotal = 0;                 // the total time note ons were held back, in micros
 
 byte midiSysExBuffer[MAX_SYSEX_LENGTH];
 short midiSysExLength = -1;
@@ -56,6 +165,35 @@ byte initialMidiClockMessageCount = 0;                     // the first MIDI clo
 boolean receivedSongPositionPointer = false;               // tracks whether a song position pointer message was received before the MIDI clock start
 boolean standaloneMidiClockRunning = false;                // indicates whether the MIDI Clock is sending data in a standalone fashion, without sequencer
 
+// MIDI Latency Tracing
+// For each type of MIDI message, one queued message at a time is traced from the touch that caused it until
+// it's written to the serial port. The latencies are collected in histograms with fixed buckets that each
+// double in size, starting with a bucket for less than 250 microseconds.
+#define MIDI_LATENCY_TYPES        6
+#define MIDI_LATENCY_BUCKETS      12
+#define MIDI_LATENCY_FIRST_BUCKET 250
+
+enum MidiLatencyType {
+  latencyNoteOn,
+  latencyNoteOff,
+  latencyPitchBend,
+  latencyControlChange,
+  latencyChannelPressure,
+  latencyPolyPressure
+};
+
+struct MidiLatencyTrace {
+  boolean active;                                          // indicates whether a message of this type is being traced
+  unsigned short slot;                                     // the continuous slot that is being traced, MIDI_SLOTS_COUNT for a message in midiOutQueue, MIDI_SLOTS_HELD and up for a note message that was set aside
+  unsigned long sequence;                                  // the sequence number of the queued message that is being traced
+  unsigned long origin;                                    // the moment in micros of the touch that caused the message
+};
+
+unsigned long midiQueuedMessageCount = 0;                  // sequence number of the next message that is queued
+unsigned long midiSentMessageCount = 0;                    // sequence number of the next message that is written to the serial port
+MidiLatencyTrace midiLatencyTraces[MIDI_LATENCY_TYPES];
+unsigned long midiLatencyHistogram[MIDI_LATENCY_TYPES][MIDI_LATENCY_BUCKETS];
+
 byte lastRpnMsb = 127;
 byte lastRpnLsb = 127;
 byte lastNrpnMsb = 127;
@@ -85,6 +223,8 @@ void applyMidiIo() {
     Serial.flush();          // clear the serial port
   }
 
+  midiOutRunningStatus = 0;
+
   applyMidiInterval();
 }
 
@@ -98,14 +238,29 @@ void handleMidiInput(unsigned long nowMicros) {
     clearLed(0, GLOBAL_SETTINGS_ROW);
   }
 
-  // if no serial data is available, return
-  if (Serial.available() <= 0) {
-    return;
-  }
+  // consume all the available bytes until the time budget for this call runs out, at least one byte is
+  // always handled so that a slow message can't stall the input
+  unsigned long budgetStart = micros();
+  int available;
+  while ((available = Serial.available()) > 0) {
+    // each byte is stamped when it's read from the receive buffer, not when it arrived, the stamp lags by the time
+    // the byte waited in the buffer; over DIN the bytes arrive one at a time, so a byte with others queued behind it
+    // arrived at least one byte transmission per queued byte earlier and is back-dated by that much
+    unsigned long byteMicros = micros();
+    if (isMidiUsingDIN()) {
+      byteMicros -= (available - 1) * MIDI_DIN_BYTE_MICROS;
+    }
+    unsigned long profileStart = beginProfile();
+    handleMidiInputByte(Serial.read(), byteMicros);
+    endProfile(profileMidiInputByte, profileStart);
 
-  // get the next byte from the serial bus
-  byte d = Serial.read();
+    if (calcTimeDelta(micros(), budgetStart) >= Device.midiInputBudget) {
+      break;
+    }
+  }
+}
 
+void handleMidiInputByte(byte d, unsigned long nowMicros) {
   // check if we're dealing with a status byte
   if ((d & B10000000) == B10000000) {
     memset(midiMessage, 0, 4);
@@ -220,12 +375,17 @@ void handleMidiInput(unsigned long nowMicros) {
         midiSysExLength = 0;
         break;
       case MIDIEndOfExclusive:
-        if (Device.midiThrough) {
-          sysexOutQueue.push(MIDISystemExclusive);
-          for (short i = 0; i < midiSysExLength; ++i) {
-            sysexOutQueue.push(midiSysExBuffer[i]);
+        // an LED frame is meant for this LinnStrument and isn't passed through
+        if (!handleLedFrameSysEx() && Device.midiThrough) {
+          // only pass the SysEx message through when it fits entirely, a partial one would corrupt the output
+          if (sysexOutQueue.free() >= (unsigned int)midiSysExLength + 2) {
+            sysexOutQueue.push(MIDISystemExclusive);
+            sysexOutQueue.pushRecord(midiSysExBuffer, midiSysExLength);
+            sysexOutQueue.push(MIDIEndOfExclusive);
+          }
+          else {
+            sysexOutQueue.drop(midiSysExLength + 2);
           }
-          sysexOutQueue.push(MIDIEndOfExclusive);
         }
         midiSysExLength = -1;
         break;
@@ -472,6 +632,7 @@ void handleMidiInput(unsigned long nowMicros) {
               unsigned long rate = midiData2 * 1000;
               if (!Device.operatingLowPower || rate > LOWPOWER_MIDI_DECIMATION) {
                 midiDecimateRate = rate;
+                midiDecimateAdaptive = false;
               }
             }
             break;
@@ -528,6 +689,69 @@ void handleMidiInput(unsigned long nowMicros) {
   }
 }
 
+// handleLedFrameSysEx:
+// Applies a received SysEx LED frame to a custom LED layer at once, returns false when the SysEx message
+// isn't an LED frame
+boolean handleLedFrameSysEx() {
+  if (midiSysExLength < SYSEX_LED_FRAME_HEADER ||
+      midiSysExBuffer[0] != 0x7D || midiSysExBuffer[1] != 'L' || midiSysExBuffer[2] != 'S' ||
+      midiSysExBuffer[3] != SYSEX_LED_FRAME_COMMAND) {
+    return false;
+  }
+
+  byte layerNumber = midiSysExBuffer[4];
+  byte frameCol = midiSysExBuffer[5];
+  byte frameRow = midiSysExBuffer[6];
+  byte frameWidth = midiSysExBuffer[7];
+  byte frameHeight = midiSysExBuffer[8];
+
+  // ignore frames that are incomplete or don't fit, a SysEx message that was too long for the buffer is cut off
+  // and can't have the exact length
+  if (midiSysExLength != SYSEX_LED_FRAME_HEADER + frameWidth * frameHeight ||
+      frameCol + frameWidth > NUMCOLS || frameRow + frameHeight > NUMROWS) {
+    return true;
+  }
+
+  if (displayMode != displayNormal && displayMode != displayCustomLedsEditor) {
+    return true;
+  }
+
+  // layer 0 picks the same layer as CC 22
+  byte layer;
+  switch (layerNumber) {
+    case 0:
+      layer = userFirmwareActive ? LED_LAYER_CUSTOM2 : LED_LAYER_CUSTOM1;
+      break;
+    case 1:
+      layer = LED_LAYER_CUSTOM1;
+      break;
+    case 2:
+      layer = LED_LAYER_CUSTOM2;
+      break;
+    default:
+      return true;
+  }
+
+  startBufferedLeds();
+  byte* cells = &midiSysExBuffer[SYSEX_LED_FRAME_HEADER];
+  for (byte row = 0; row < frameHeight; ++row) {
+    for (byte col = 0; col < frameWidth; ++col) {
+      byte color = *cells & B00001111;
+      byte disp = (*cells & B01110000) >> 4;
+      if (color <= COLOR_PINK && color != COLOR_OFF && disp <= cellFocusPulse) {
+        setLed(frameCol + col, frameRow + row, color, (CellDisplay)disp, layer);
+      }
+      else {
+        setLed(frameCol + col, frameRow + row, COLOR_OFF, cellOff, layer);
+      }
+      ++cells;
+    }
+  }
+  finishBufferedLeds();
+
+  return true;
+}
+
 signed char determineSplitForChannel(byte channel) {
   if (channel > 15) {
     return -1;
@@ -1106,12 +1330,14 @@ void receivedNrpn(int parameter, int value, int channel) {
     case 232:
       if (inRange(value, 0, 3)) {
         Global.velocitySensitivity = (VelocitySensitivity)value;
+        applySensorRangesZ();
       }
       break;
     // Global Pressure Sensitivity
     case 233:
       if (inRange(value, 0, 2)) {
         Global.pressureSensitivity = (PressureSensitivity)value;
+        applySensorRangesZ();
       }
       break;
     // Device MIDI I/O
@@ -1178,6 +1404,7 @@ void receivedNrpn(int parameter, int value, int channel) {
     case 244:
       if (inRange(value, 0, 1)) {
         Global.pressureAftertouch = value;
+        applySensorRangesZ();
       }
       break;
     // Device User Firmware Mode Active
@@ -1351,10 +1578,70 @@ void receivedNrpn(int parameter, int value, int channel) {
         Global.guitarTuning[7] = value;
       }
       break;
+    // Global Velocity Onset
+    case 271:
+      if (inRange(value, 0, 2)) {
+        Global.velocityOnset = value;
+      }
+      break;
+    // Device MIDI Running Status Over DIN
+    case 272:
+      if (inRange(value, 0, 1)) {
+        Device.midiRunningStatus = value;
+        midiOutRunningStatus = 0;
+      }
+      break;
+    // Device Minimum Interval Before Retriggering A Note Over USB
+    case 273:
+      if (inRange(value, 0, 10000)) {
+        Device.midiRetriggerUSB = value;
+        applyMidiInterval();
+      }
+      break;
+    // Device Minimum Interval Before Retriggering A Note Over DIN
+    case 274:
+      if (inRange(value, 0, 10000)) {
+        Device.midiRetriggerDIN = value;
+        applyMidiInterval();
+      }
+      break;
+    // Device Batched MIDI Writes
+    case 275:
+      if (inRange(value, 0, 1)) {
+        Device.midiBatchedWrites = value;
+      }
+      break;
+    // Device MIDI Input Time Budget
+    case 276:
+      if (inRange(value, 10, 2000)) {
+        Device.midiInputBudget = value;
+        applyMidiInterval();
+      }
+      break;
     // Query for the value of a particular parameter
     case 299:
       sendNrpnParameter(value, channel);
       break;
+    // Reset the MIDI latency histograms and output statistics
+    case 372:
+      resetMidiLatencyHistograms();
+      midiOutWrittenBytes = 0;
+      midiOutOmittedBytes = 0;
+      midiRetriggerDelayCount = 0;
+      midiRetriggerDelayTotal = 0;
+      midiOutHighWaterMark = 0;
+      midiOutQueue.resetStatistics();
+      sysexOutQueue.resetStatistics();
+      resetContinuousTaskStatistics();
+      resetProfile();
+      resetVelocityOnsetStatistics();
+      break;
+    // Activate the CPU profiler
+    case 379:
+      if (inRange(value, 0, 1)) {
+        setProfilerActive(value);
+      }
+      break;
   }
 
   updateDisplay();
@@ -1697,6 +1984,80 @@ void sendNrpnParameter(int parameter, int channel) {
     case 270:
       value = Global.guitarTuning[7];
       break;
+    case 271:
+      value = Global.velocityOnset;
+      break;
+    case 272:
+      value = Device.midiRunningStatus;
+      break;
+    case 273:
+      value = Device.midiRetriggerUSB;
+      break;
+    case 274:
+      value = Device.midiRetriggerDIN;
+      break;
+    case 275:
+      value = Device.midiBatchedWrites;
+      break;
+    case 276:
+      value = Device.midiInputBudget;
+      break;
+    case 373:
+    {
+      unsigned long total = midiOutWrittenBytes + midiOutOmittedBytes;
+      value = (total == 0 ? 0 : (int)((midiOutOmittedBytes * 100ULL) / total));
+      break;
+    }
+    case 374:
+      value = min(midiRetriggerDelayCount, (unsigned long)16383);
+      break;
+    case 375:
+      value = min(midiRetriggerDelayTotal / 1000, (unsigned long)16383);
+      break;
+    case 376:
+      value = min(midiDecimateRate / 100, (unsigned long)16383);
+      break;
+    case 377:
+      value = min(midiOutHighWaterMark, (unsigned short)16383);
+      break;
+    case 378:
+      value = min(midiOutQueue.dropped() + sysexOutQueue.dropped(), (unsigned long)16383);
+      break;
+    case 379:
+      value = profilerActive;
+      break;
+    default:
+      // MIDI latency histograms, 12 buckets for each message type
+      if (param >= 300 && param < 300 + MIDI_LATENCY_TYPES * MIDI_LATENCY_BUCKETS) {
+        unsigned long count = midiLatencyHistogram[(param - 300) / MIDI_LATENCY_BUCKETS][(param - 300) % MIDI_LATENCY_BUCKETS];
+        value = min(count, (unsigned long)16383);
+      }
+      // continuous task deadline and budget overruns, one for each task
+      else if (param >= 380 && param < 380 + CONTINUOUS_TASK_COUNT) {
+        value = min(continuousTasks[param - 380].deadlineOverruns, (unsigned long)16383);
+      }
+      else if (param >= 390 && param < 390 + CONTINUOUS_TASK_COUNT) {
+        value = min(continuousTasks[param - 390].budgetOverruns, (unsigned long)16383);
+      }
+      // CPU profiler block, five values for each section
+      else if (param >= 400 && param < 400 + PROFILE_SECTIONS * PROFILE_NRPN_FIELDS) {
+        value = getProfileNrpnValue(param - 400);
+      }
+      // early velocity onset statistics, the differences with the final velocity, the late touches and the time saved
+      else if (param >= 490 && param < 490 + VELOCITY_ONSET_BUCKETS) {
+        value = min(velocityOnsetHistogram[param - 490], (unsigned long)16383);
+      }
+      else if (param == 498) {
+        value = min(velocityOnsetLateCount, (unsigned long)16383);
+      }
+      else if (param == 499) {
+        unsigned long early = 0;
+        for (byte b = 0; b < VELOCITY_ONSET_BUCKETS; ++b) {
+          early += velocityOnsetHistogram[b];
+        }
+        value = (early == 0 ? 0 : min(velocityOnsetSavedTotal / early, (unsigned long)16383));
+      }
+      break;
   }
 
   if (value != INT_MIN) {
@@ -1822,17 +2183,34 @@ short getNoteNumColumn(byte split, byte notenum, byte row) {
 
 // Arrays to keep track of the last sent MIDI values to allow the MIDI output
 // routines to not unnecessarily send out duplicate data
-byte lastValueMidiCC[16][128];
 int  lastValueMidiPB[16];
 byte lastValueMidiAT[16];
-byte lastValueMidiPP[16][128];
 
-// Arrays to keep track of the last moment of MIDI values to allow for MIDI output
-// decimation
-unsigned long lastMomentMidiCC[16][128];
+// Arrays to keep track of the last moment continuous MIDI values were sent to allow
+// for MIDI output decimation
 unsigned long lastMomentMidiPB[16];
 unsigned long lastMomentMidiAT[16];
-unsigned long lastMomentMidiPP[16][128];
+
+// MIDI Tracked Slots
+// Only a handful of the 4096 CC and poly pressure slots are in use at any time, their last value and send moment
+// are kept in a small set-associative table instead of full arrays. A slot that isn't in the table has an unknown
+// value and is always due, so the worst that can happen after an eviction is a duplicate message that is sent
+// without decimation.
+#define MIDI_TRACKED_SLOTS       128                       // must be a power of two
+#define MIDI_TRACKED_WAYS        4                         // entries per bucket
+#define MIDI_TRACKED_BUCKETS     (MIDI_TRACKED_SLOTS / MIDI_TRACKED_WAYS)
+#define MIDI_TRACKED_MOMENT_BITS 6                         // moments are kept in units of 64 micros, wrapping after about 4 seconds
+#define MIDI_TRACKED_EXPIRY      31250                     // moments older than 2 seconds are forgotten before they can wrap
+#define MIDI_TRACKED_SWEEP       4                         // number of entries that are checked for expiry each decimation period
+
+struct MidiTrackedSlot {
+  unsigned short slot;                                     // the CC or poly pressure slot, MIDI_SLOTS_COUNT when the entry is unused
+  byte value;                                              // the last value that was sent, 0xFF when unknown
+  boolean recent;                                          // true when the moment is recent enough to be compared with
+  unsigned short moment;                                   // the last moment the slot was sent, in units of 64 micros
+};
+MidiTrackedSlot midiTrackedSlots[MIDI_TRACKED_SLOTS];
+unsigned short midiTrackedSweep = 0;
 
 inline byte getBendRange(byte split) {
   byte bendRange = 0;
@@ -2120,8 +2498,7 @@ void resetLastMidiPolyPressure(byte note, byte channel) {
   note = constrain(note, 0, 127);
   channel = constrain(channel-1, 0, 15);
 
-  lastValueMidiPP[channel][note] = 0xFF;
-  lastMomentMidiPP[channel][note] = 0;
+  forgetMidiTrackedSlot(getMidiSlot(MIDIPolyphonicPressure, note, channel));
 }
 
 void resetLastMidiAfterTouch(byte channel) {
@@ -2202,8 +2579,7 @@ void resetLastMidiCC(byte controlnum, byte channel) {
   controlnum = constrain(controlnum, 0, 127);
   channel = constrain(channel-1, 0, 15);
 
-  lastValueMidiCC[channel][controlnum] = 0xFF;
-  lastMomentMidiCC[channel][controlnum] = 0;
+  forgetMidiTrackedSlot(getMidiSlot(MIDIControlChange, controlnum, channel));
 }
 
 void resetLastMidiPitchBend(byte channel) {
@@ -2264,126 +2640,949 @@ void initializeLastMidiTracking() {
     lastValueMidiAT[ch] = 0xFF;
     lastMomentMidiPB[ch] = 0;
     lastMomentMidiAT[ch] = 0;
-    for (byte msg = 0; msg < 128; ++msg) {
-      lastValueMidiCC[ch][msg] = 0xFF;
-      lastValueMidiPP[ch][msg] = 0xFF;
-      lastMomentMidiCC[ch][msg] = 0;
-      lastMomentMidiPP[ch][msg] = 0;
-    }
+  }
+  clearMidiTrackedSlots();
 
-    performContinuousTasks();
+  // Initialize the bitmaps that track which MIDI notes are on
+  for (byte s = 0; s < NUMSPLITS; ++s) {
+    clearMidiNotesOn(s);
   }
+}
 
-  // Initialize the arrays that track which MIDI notes are on
-  for (byte s = 0; s < 2; ++s) {
-    for (byte c = 0; c < 16; ++c) {
-      for (byte n = 0; n < 128; ++n) {
-        lastValueMidiNotesOn[s][n][c] = 0;
+void resetMidiLatencyHistograms() {
+  memset(midiLatencyHistogram, 0, sizeof(midiLatencyHistogram));
+}
+
+signed char getMidiLatencyType(MIDIStatus type) {
+  switch (type) {
+    case MIDINoteOn:
+      return latencyNoteOn;
+    case MIDINoteOff:
+      return latencyNoteOff;
+    case MIDIPitchBend:
+      return latencyPitchBend;
+    case MIDIControlChange:
+      return latencyControlChange;
+    case MIDIChannelPressure:
+      return latencyChannelPressure;
+    case MIDIPolyphonicPressure:
+      return latencyPolyPressure;
+    default:
+      return -1;
+  }
+}
+
+// traceQueuedMidiMessage:
+// Starts tracing a queued message when it's caused by a touch and no other message of the same type is being traced
+inline void traceQueuedMidiMessage(MIDIStatus type) {
+  if (midiLatencyOrigin != 0) {
+    signed char latencyType = getMidiLatencyType(type);
+    if (latencyType != -1 && !midiLatencyTraces[latencyType].active) {
+      unsigned long origin = (type == MIDINoteOn ? midiNoteOnLatencyOrigin : midiLatencyOrigin);
+      if (origin != 0) {
+        midiLatencyTraces[latencyType].active = true;
+        midiLatencyTraces[latencyType].slot = MIDI_SLOTS_COUNT;
+        midiLatencyTraces[latencyType].sequence = midiQueuedMessageCount;
+        midiLatencyTraces[latencyType].origin = origin;
       }
+    }
+  }
+  midiQueuedMessageCount++;
+}
+
+// traceQueuedMidiSlot:
+// Starts tracing a continuous slot when its value is caused by a touch, the trace ends when the slot is sent
+inline void traceQueuedMidiSlot(MIDIStatus type, unsigned short slot) {
+  if (midiLatencyOrigin != 0) {
+    signed char latencyType = getMidiLatencyType(type);
+    if (latencyType != -1 && !midiLatencyTraces[latencyType].active) {
+      midiLatencyTraces[latencyType].active = true;
+      midiLatencyTraces[latencyType].slot = slot;
+      midiLatencyTraces[latencyType].origin = midiLatencyOrigin;
+    }
+  }
+}
+
+void recordMidiLatency(byte latencyType, unsigned long now) {
+  unsigned long latency = calcTimeDelta(now, midiLatencyTraces[latencyType].origin);
+  byte bucket = 0;
+  unsigned long limit = MIDI_LATENCY_FIRST_BUCKET;
+  while (bucket < MIDI_LATENCY_BUCKETS - 1 && latency >= limit) {
+    bucket++;
+    limit <<= 1;
+  }
+  midiLatencyHistogram[latencyType][bucket]++;
+  midiLatencyTraces[latencyType].active = false;
+}
+
+// traceSentMidiMessage:
+// Adds the latency of a traced message to the histogram when it has been written to the serial port
+inline void traceSentMidiMessage(unsigned long now) {
+  for (byte t = 0; t < MIDI_LATENCY_TYPES; ++t) {
+    if (midiLatencyTraces[t].active && midiLatencyTraces[t].slot == MIDI_SLOTS_COUNT &&
+        (long)(midiSentMessageCount - midiLatencyTraces[t].sequence) >= 0) {
+      recordMidiLatency(t, now);
+    }
+  }
+  midiSentMessageCount++;
+}
+
+// traceSentMidiSlot:
+// Adds the latency of a traced continuous slot to the histogram when it has been written to the serial port
+inline void traceSentMidiSlot(unsigned short slot, unsigned long now) {
+  for (byte t = 0; t < MIDI_LATENCY_TYPES; ++t) {
+    if (midiLatencyTraces[t].active && midiLatencyTraces[t].slot == slot) {
+      recordMidiLatency(t, now);
+    }
+  }
+}
 
-      performContinuousTasks();
+// traceHeldMidiMessage:
+// A message that is set aside leaves midiOutQueue before it's sent, its trace continues with a slot of its own
+inline void traceHeldMidiMessage(unsigned short heldSlot) {
+  for (byte t = 0; t < MIDI_LATENCY_TYPES; ++t) {
+    if (midiLatencyTraces[t].active && midiLatencyTraces[t].slot == MIDI_SLOTS_COUNT &&
+        midiLatencyTraces[t].sequence == midiSentMessageCount) {
+      midiLatencyTraces[t].slot = heldSlot;
     }
   }
+  midiSentMessageCount++;
+}
+
+// resyncMidiLatencyTraces:
+// When the queue is empty, all queued messages have been sent, this discards the traces of messages that were lost
+inline void resyncMidiLatencyTraces() {
+  if (midiSentMessageCount != midiQueuedMessageCount) {
+    for (byte t = 0; t < MIDI_LATENCY_TYPES; ++t) {
+      if (midiLatencyTraces[t].slot == MIDI_SLOTS_COUNT) {
+        midiLatencyTraces[t].active = false;
+      }
+    }
+    midiSentMessageCount = midiQueuedMessageCount;
+  }
+}
+
+// hasMidiQueueRoom:
+// Checks if a number of messages can be queued, only note offs are allowed to use the reserved part of the queue
+boolean hasMidiQueueRoom(MIDIStatus type, byte messages) {
+  unsigned int needed = messages * 4;
+  if (type != MIDINoteOff) {
+    needed += MIDI_NOTE_OFF_RESERVE;
+  }
+  return midiOutQueue.free() >= needed;
+}
+
+// reserveMidiMessages:
+// Checks that a sequence of messages fits as a whole, when it doesn't the entire sequence is accounted as dropped
+// so that a receiver never gets a partial RPN or NRPN
+boolean reserveMidiMessages(byte messages) {
+  if (!hasMidiQueueRoom(MIDIControlChange, messages)) {
+    midiOutQueue.drop(messages * 4);
+    return false;
+  }
+  return true;
 }
 
-void queueMidiMessage(MIDIStatus type, byte param1, byte param2, byte channel) {
+// queueMidiMessage:
+// Returns false when the queue is full, the message is then dropped as a whole so that the queue stays aligned
+boolean queueMidiMessage(MIDIStatus type, byte param1, byte param2, byte channel) {
+  if (!hasMidiQueueRoom(type, 1)) {
+    midiOutQueue.drop(4);
+    return false;
+  }
+
   // we always queue four bytes and will process them as MIDI messages in the handlePendingMidi
-  midiOutQueue.push(channel & 0x0F);
-  midiOutQueue.push((byte)type);
-  midiOutQueue.push(param1 & 0x7F);
-  midiOutQueue.push(param2 & 0x7F);
+  byte record[4] = {(byte)(channel & 0x0F), (byte)type, (byte)(param1 & 0x7F), (byte)(param2 & 0x7F)};
+  if (!midiOutQueue.pushRecord(record, 4)) {
+    return false;
+  }
+
+  traceQueuedMidiMessage(type);
+  return true;
+}
+
+unsigned short getMidiSlot(MIDIStatus type, byte param1, byte channel) {
+  switch (type) {
+    case MIDIControlChange:
+      return MIDI_SLOTS_CC + ((channel & 0x0F) << 7) + (param1 & 0x7F);
+    case MIDIPolyphonicPressure:
+      return MIDI_SLOTS_PP + ((channel & 0x0F) << 7) + (param1 & 0x7F);
+    case MIDIPitchBend:
+      return MIDI_SLOTS_PB + (channel & 0x0F);
+    case MIDIChannelPressure:
+      return MIDI_SLOTS_AT + (channel & 0x0F);
+    default:
+      return MIDI_SLOTS_COUNT;
+  }
+}
+
+byte getMidiSlotChannel(unsigned short slot) {
+  if (slot >= MIDI_SLOTS_PB) {
+    return (slot - MIDI_SLOTS_PB) & 0x0F;
+  }
+  return (slot >> 7) & 0x0F;
+}
+
+// getMidiWaitingEntry:
+// Returns the entry of a slot in midiWaitingSlots, or MIDI_WAITING_NONE when it's not waiting
+byte getMidiWaitingEntry(unsigned short slot) {
+  unsigned long long entries = midiChannelWaiting[getMidiSlotChannel(slot)];
+  while (entries) {
+    byte e = __builtin_ctzll(entries);
+    if (midiWaitingSlots[e].slot == slot) {
+      return e;
+    }
+    entries &= entries - 1;
+  }
+  return MIDI_WAITING_NONE;
+}
+
+inline boolean isMidiSlotWaiting(unsigned short slot) {
+  return getMidiWaitingEntry(slot) != MIDI_WAITING_NONE;
+}
+
+inline void linkWaitingMidiSlot(byte e) {
+  midiWaitingSlots[e].previous = midiWaitingLast;
+  midiWaitingSlots[e].next = MIDI_WAITING_NONE;
+  if (midiWaitingLast == MIDI_WAITING_NONE) {
+    midiWaitingFirst = e;
+  }
+  else {
+    midiWaitingSlots[midiWaitingLast].next = e;
+  }
+  midiWaitingLast = e;
+}
+
+inline void unlinkWaitingMidiSlot(byte e) {
+  MidiWaitingSlot& entry = midiWaitingSlots[e];
+  if (entry.previous == MIDI_WAITING_NONE) {
+    midiWaitingFirst = entry.next;
+  }
+  else {
+    midiWaitingSlots[entry.previous].next = entry.next;
+  }
+  if (entry.next == MIDI_WAITING_NONE) {
+    midiWaitingLast = entry.previous;
+  }
+  else {
+    midiWaitingSlots[entry.next].previous = entry.previous;
+  }
+}
+
+// startWaitingMidiSlot:
+// Takes a free entry for a slot that starts waiting, returns MIDI_WAITING_NONE when all the entries are in use
+byte startWaitingMidiSlot(unsigned short slot) {
+  if (midiWaitingCount == MIDI_WAITING_SLOTS) {
+    return MIDI_WAITING_NONE;
+  }
+
+  byte e = __builtin_ctzll(~midiWaitingUsed);
+  midiWaitingUsed |= (1ULL << e);
+  midiChannelWaiting[getMidiSlotChannel(slot)] |= (1ULL << e);
+  midiWaitingCount++;
+
+  midiWaitingSlots[e].slot = slot;
+  midiWaitingSlots[e].order = midiWaitingOrder++;
+  linkWaitingMidiSlot(e);
+  return e;
+}
+
+void stopWaitingMidiSlot(byte e) {
+  unlinkWaitingMidiSlot(e);
+  midiWaitingUsed &= ~(1ULL << e);
+  midiChannelWaiting[getMidiSlotChannel(midiWaitingSlots[e].slot)] &= ~(1ULL << e);
+  midiWaitingCount--;
+}
+
+// findOldestWaitingMidiSlot:
+// Returns the entry of the channel that has been waiting the longest, or MIDI_WAITING_NONE
+byte findOldestWaitingMidiSlot(byte channel) {
+  byte oldest = MIDI_WAITING_NONE;
+  unsigned long long entries = midiChannelWaiting[channel];
+  while (entries) {
+    byte e = __builtin_ctzll(entries);
+    if (oldest == MIDI_WAITING_NONE || (short)(midiWaitingSlots[e].order - midiWaitingSlots[oldest].order) < 0) {
+      oldest = e;
+    }
+    entries &= entries - 1;
+  }
+  return oldest;
+}
+
+// getPrecedingMidiSlot:
+// The MSB of a 14-bit control change is always sent before its LSB since it resets the LSB, this returns the entry
+// of the MSB when it's waiting together with the LSB of an entry, and the entry itself otherwise
+byte getPrecedingMidiSlot(byte e) {
+  unsigned short slot = midiWaitingSlots[e].slot;
+  if (slot < MIDI_SLOTS_PP && (slot & 0x7F) >= 32 && (slot & 0x7F) < 64) {
+    byte msb = getMidiWaitingEntry(slot - 32);
+    if (msb != MIDI_WAITING_NONE) {
+      return msb;
+    }
+  }
+  return e;
+}
+
+// MIDI tracked slots:
+// The last value and send moment of CC and poly pressure slots, see MIDI_TRACKED_SLOTS
+void clearMidiTrackedSlots() {
+  for (unsigned short i = 0; i < MIDI_TRACKED_SLOTS; ++i) {
+    midiTrackedSlots[i].slot = MIDI_SLOTS_COUNT;
+    midiTrackedSlots[i].value = 0xFF;
+    midiTrackedSlots[i].recent = false;
+    midiTrackedSlots[i].moment = 0;
+  }
+  midiTrackedSweep = 0;
+}
+
+inline unsigned short getMidiTrackedBucket(unsigned short slot) {
+  // mix the channel into the controller or note so that the same controller on all channels spreads out
+  return ((slot ^ (slot >> 7)) & (MIDI_TRACKED_BUCKETS - 1)) * MIDI_TRACKED_WAYS;
+}
+
+inline unsigned short getMidiTrackedMoment(unsigned long now) {
+  return (unsigned short)(now >> MIDI_TRACKED_MOMENT_BITS);
+}
+
+// findMidiTrackedSlot:
+// Returns the table index of a slot, or -1 when it's not tracked
+short findMidiTrackedSlot(unsigned short slot) {
+  unsigned short bucket = getMidiTrackedBucket(slot);
+  for (byte w = 0; w < MIDI_TRACKED_WAYS; ++w) {
+    if (midiTrackedSlots[bucket + w].slot == slot) {
+      return bucket + w;
+    }
+  }
+  return -1;
+}
+
+// trackMidiSlot:
+// Returns the table index of a slot, taking over an entry of its bucket when it's not tracked yet,
+// unused entries are taken first, then the ones that aren't waiting to be sent and were sent the longest ago
+short trackMidiSlot(unsigned short slot, unsigned long now) {
+  short index = findMidiTrackedSlot(slot);
+  if (index >= 0) {
+    return index;
+  }
+
+  unsigned short bucket = getMidiTrackedBucket(slot);
+  unsigned short current = getMidiTrackedMoment(now);
+  long bestScore = -1;
+  index = bucket;
+  for (byte w = 0; w < MIDI_TRACKED_WAYS; ++w) {
+    MidiTrackedSlot& entry = midiTrackedSlots[bucket + w];
+    long score;
+    if (entry.slot == MIDI_SLOTS_COUNT) {
+      score = 0x40000;
+    }
+    else {
+      score = entry.recent ? (unsigned short)(current - entry.moment) : 0xFFFF;
+      if (!isMidiSlotWaiting(entry.slot)) {
+        score += 0x20000;
+      }
+    }
+    if (score > bestScore) {
+      bestScore = score;
+      index = bucket + w;
+    }
+  }
+
+  MidiTrackedSlot& entry = midiTrackedSlots[index];
+  entry.slot = slot;
+  entry.value = 0xFF;
+  entry.recent = false;
+  entry.moment = 0;
+  return index;
+}
+
+void forgetMidiTrackedSlot(unsigned short slot) {
+  short index = findMidiTrackedSlot(slot);
+  if (index >= 0) {
+    midiTrackedSlots[index].slot = MIDI_SLOTS_COUNT;
+    midiTrackedSlots[index].value = 0xFF;
+    midiTrackedSlots[index].recent = false;
+  }
+}
+
+byte getLastMidiValue(unsigned short slot) {
+  short index = findMidiTrackedSlot(slot);
+  if (index < 0) {
+    return 0xFF;
+  }
+  return midiTrackedSlots[index].value;
+}
+
+void setLastMidiValue(unsigned short slot, byte value) {
+  midiTrackedSlots[trackMidiSlot(slot, micros())].value = value;
+}
+
+// expireMidiTrackedSlots:
+// Walks through a few entries at a time to forget moments before their 16-bit representation wraps around,
+// a slot with a forgotten moment is due just like one that was never sent
+void expireMidiTrackedSlots(unsigned long now) {
+  unsigned short current = getMidiTrackedMoment(now);
+  for (byte i = 0; i < MIDI_TRACKED_SWEEP; ++i) {
+    MidiTrackedSlot& entry = midiTrackedSlots[midiTrackedSweep];
+    if (entry.recent && (unsigned short)(current - entry.moment) > MIDI_TRACKED_EXPIRY) {
+      entry.recent = false;
+    }
+    midiTrackedSweep = (midiTrackedSweep + 1) & (MIDI_TRACKED_SLOTS - 1);
+  }
+}
+
+// getMidiSlotAge:
+// The time since a continuous slot was last sent, pitch bend and aftertouch use the same arrays as decimation,
+// CC and poly pressure slots that weren't sent recently are reported as being older than any decimation rate
+unsigned long getMidiSlotAge(unsigned short slot, unsigned long now) {
+  if (slot >= MIDI_SLOTS_AT) {
+    return calcTimeDelta(now, lastMomentMidiAT[slot - MIDI_SLOTS_AT]);
+  }
+  if (slot >= MIDI_SLOTS_PB) {
+    return calcTimeDelta(now, lastMomentMidiPB[slot - MIDI_SLOTS_PB]);
+  }
+
+  short index = findMidiTrackedSlot(slot);
+  if (index < 0 || !midiTrackedSlots[index].recent) {
+    return 0xFFFFFFFF;
+  }
+  unsigned short age = getMidiTrackedMoment(now) - midiTrackedSlots[index].moment;
+  return (unsigned long)age << MIDI_TRACKED_MOMENT_BITS;
+}
+
+void setMidiSlotMoment(unsigned short slot, unsigned long now) {
+  if (slot >= MIDI_SLOTS_AT) {
+    lastMomentMidiAT[slot - MIDI_SLOTS_AT] = now;
+  }
+  else if (slot >= MIDI_SLOTS_PB) {
+    lastMomentMidiPB[slot - MIDI_SLOTS_PB] = now;
+  }
+  else {
+    MidiTrackedSlot& entry = midiTrackedSlots[trackMidiSlot(slot, now)];
+    entry.recent = true;
+    entry.moment = getMidiTrackedMoment(now);
+  }
+}
+
+// queueContinuousMidiMessage:
+// Stores the latest value of a continuous message in its slot, the slot only starts waiting to be sent when it
+// wasn't waiting already. If no more slots can wait, the message is queued in order instead so that it's not lost.
+void queueContinuousMidiMessage(MIDIStatus type, byte param1, byte param2, byte channel) {
+  unsigned short slot = getMidiSlot(type, param1, channel);
+  if (slot == MIDI_SLOTS_COUNT) {
+    queueMidiMessage(type, param1, param2, channel);
+    return;
+  }
+
+  byte e = getMidiWaitingEntry(slot);
+  if (e == MIDI_WAITING_NONE) {
+    e = startWaitingMidiSlot(slot);
+    if (e == MIDI_WAITING_NONE) {
+      queueMidiMessage(type, param1, param2, channel);
+      return;
+    }
+  }
+
+  MidiWaitingSlot& entry = midiWaitingSlots[e];
+  switch (type) {
+    case MIDIPitchBend:
+      entry.value = param1 & 0x7F;
+      entry.msb = param2 & 0x7F;
+      break;
+    case MIDIChannelPressure:
+      entry.value = param1 & 0x7F;
+      break;
+    default:
+      entry.value = param2 & 0x7F;
+      break;
+  }
+
+  traceQueuedMidiSlot(type, slot);
+}
+
+// cancelContinuousMidiMessage:
+// Ordered messages supersede the value that's waiting in the slot of the same controller
+void cancelContinuousMidiMessage(MIDIStatus type, byte param1, byte channel) {
+  unsigned short slot = getMidiSlot(type, param1, channel);
+  if (slot == MIDI_SLOTS_COUNT) return;
+
+  byte e = getMidiWaitingEntry(slot);
+  if (e == MIDI_WAITING_NONE) return;
+
+  stopWaitingMidiSlot(e);
+  for (byte t = 0; t < MIDI_LATENCY_TYPES; ++t) {
+    if (midiLatencyTraces[t].slot == slot) {
+      midiLatencyTraces[t].active = false;
+    }
+  }
+}
+
+// isMidiSlotDue:
+// Decimation holds back a new value until the interval since the previous send of the slot has passed,
+// values that return a control to its rest position are never held back
+boolean isMidiSlotDue(byte e, unsigned long now) {
+  MidiWaitingSlot& entry = midiWaitingSlots[e];
+  if (entry.slot >= MIDI_SLOTS_PB && entry.slot < MIDI_SLOTS_AT) {
+    if (entry.value == 0 && entry.msb == 0x40) return true;
+  }
+  else if (entry.value == 0) {
+    return true;
+  }
+  return getMidiSlotAge(entry.slot, now) > midiDecimateRate;
+}
+
+// takeMidiSlot:
+// Constitutes the four byte message record of a waiting slot with its latest value, returns the slot number
+unsigned short takeMidiSlot(byte e, unsigned long now, byte* record) {
+  MidiWaitingSlot& entry = midiWaitingSlots[e];
+  unsigned short slot = entry.slot;
+  byte channel = getMidiSlotChannel(slot);
+  record[0] = channel;
+  if (slot >= MIDI_SLOTS_AT) {
+    record[1] = MIDIChannelPressure;
+    record[2] = entry.value;
+    record[3] = 0;
+  }
+  else if (slot >= MIDI_SLOTS_PB) {
+    record[1] = MIDIPitchBend;
+    record[2] = entry.value;
+    record[3] = entry.msb;
+  }
+  else if (slot >= MIDI_SLOTS_PP) {
+    record[1] = MIDIPolyphonicPressure;
+    record[2] = slot & 0x7F;
+    record[3] = entry.value;
+  }
+  else {
+    record[1] = MIDIControlChange;
+    record[2] = slot & 0x7F;
+    record[3] = entry.value;
+  }
+
+  stopWaitingMidiSlot(e);
+  setMidiSlotMoment(slot, now);
+  return slot;
+}
+
+// takeDueMidiSlot:
+// Sends the waiting slots in the order they started waiting, skipping those held back by decimation
+boolean takeDueMidiSlot(unsigned long now, byte* record, unsigned short& slot) {
+  for (byte i = 0; i < MIDI_WAITING_ROTATIONS && midiWaitingFirst != MIDI_WAITING_NONE; ++i) {
+    byte e = midiWaitingFirst;
+
+    byte preceding = getPrecedingMidiSlot(e);
+    if (preceding != e) {
+      slot = takeMidiSlot(preceding, now, record);
+      return true;
+    }
+
+    if (!isMidiSlotDue(e, now)) {
+      unlinkWaitingMidiSlot(e);
+      linkWaitingMidiSlot(e);
+      continue;
+    }
+
+    slot = takeMidiSlot(e, now, record);
+    return true;
+  }
+
+  return false;
+}
+
+// takeNextMidiMessage:
+// Selects the message that is sent next. Ordered messages go first, except note on and note off messages that are
+// held back until the continuous data of their channel has been sent, this prepares a note on with the pitch bend
+// and timbre of its touch and makes a note off follow the last values of its release. A note on that retriggers a
+// note too soon is set aside until the retrigger interval has passed, the messages behind it can go ahead. The
+// continuous slots are sent when no ordered messages are left, and also after every streak of ordered messages so
+// that they can't starve.
+boolean takeNextMidiMessage(unsigned long now, byte* record, unsigned short& slot) {
+  static boolean noteHeld = false;
+  static byte noteHeldSlots = 0;
+  static byte orderedStreak = 0;
+  static boolean retriggerHeld = false;
+  static unsigned long retriggerHeldSince = 0;
+
+  if (midiHeldNoteOnCount > 0 && takeHeldMidiNoteOn(now, record, slot)) {
+    return true;
+  }
+
+  boolean orderedReady = false;
+  while (!midiOutQueue.empty()) {
+    byte channel = midiOutQueue.peek();
+    byte type = midiOutQueue.peek(1);
+    byte note = midiOutQueue.peek(2);
+    if (type != MIDINoteOn && type != MIDINoteOff) {
+      orderedReady = true;
+      break;
+    }
+
+    // only the slots that were waiting when the note message got its turn are sent first, so that
+    // continuous data of other touches on the same channel can't hold back the note message
+    if (!noteHeld) {
+      noteHeld = true;
+      noteHeldSlots = __builtin_popcountll(midiChannelWaiting[channel]);
+    }
+    if (noteHeldSlots > 0) {
+      noteHeldSlots--;
+      byte e = findOldestWaitingMidiSlot(channel);
+      if (e != MIDI_WAITING_NONE) {
+        slot = takeMidiSlot(getPrecedingMidiSlot(e), now, record);
+        return true;
+      }
+    }
+
+    boolean noteOff = (type == MIDINoteOff || midiOutQueue.peek(3) == 0);
+
+    // the note messages of a note on that is set aside can't overtake it, its note off is attached to it
+    short heldIndex = findHeldMidiNoteOn(channel, note);
+    if (heldIndex >= 0) {
+      MidiHeldNoteOn& held = midiHeldNoteOns[heldIndex];
+      if (noteOff && !held.noteOffPending) {
+        traceHeldMidiMessage(MIDI_SLOTS_HELD + heldIndex * 2 + 1);
+        midiOutQueue.pop();
+        held.noteOffType = midiOutQueue.pop();
+        midiOutQueue.pop();
+        held.noteOffVelocity = midiOutQueue.pop();
+        held.noteOffPending = true;
+        noteHeld = false;
+        continue;
+      }
+      // a second retrigger of the same note, this is rare enough to simply wait at the head of the queue
+      break;
+    }
+
+    if (!noteOff && isMidiRetriggerPending(channel, note, now)) {
+      if (holdMidiNoteOn(now)) {
+        noteHeld = false;
+        continue;
+      }
+      // when no more note ons can be set aside, this one waits at the head of the queue
+      if (!retriggerHeld) {
+        retriggerHeld = true;
+        retriggerHeldSince = now;
+      }
+      break;
+    }
+
+    orderedReady = true;
+    break;
+  }
+
+  if (orderedReady) {
+    if (orderedStreak >= MIDI_ORDERED_STREAK) {
+      orderedStreak = 0;
+      if (takeDueMidiSlot(now, record, slot)) {
+        return true;
+      }
+    }
+
+    if (retriggerHeld) {
+      retriggerHeld = false;
+      midiRetriggerDelayCount++;
+      midiRetriggerDelayTotal += calcTimeDelta(now, retriggerHeldSince);
+    }
+    noteHeld = false;
+    orderedStreak++;
+
+    for (byte i = 0; i < 4; ++i) {
+      record[i] = midiOutQueue.pop();
+    }
+    slot = MIDI_SLOTS_COUNT;
+    return true;
+  }
+
+  orderedStreak = 0;
+  return takeDueMidiSlot(now, record, slot);
+}
+
+// findHeldMidiNoteOn:
+// Returns the index of the held note on of a note, or -1 when it's not held
+short findHeldMidiNoteOn(byte channel, byte note) {
+  for (byte i = 0; i < MIDI_HELD_NOTE_ONS; ++i) {
+    MidiHeldNoteOn& held = midiHeldNoteOns[i];
+    if (held.active && held.channel == channel && held.note == note) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// holdMidiNoteOn:
+// Moves the note on at the head of midiOutQueue aside, returns false when no more note ons can be held
+boolean holdMidiNoteOn(unsigned long now) {
+  for (byte i = 0; i < MIDI_HELD_NOTE_ONS; ++i) {
+    MidiHeldNoteOn& held = midiHeldNoteOns[i];
+    if (!held.active) {
+      traceHeldMidiMessage(MIDI_SLOTS_HELD + i * 2);
+      held.active = true;
+      held.noteOnSent = false;
+      held.noteOffPending = false;
+      held.channel = midiOutQueue.pop();
+      midiOutQueue.pop();
+      held.note = midiOutQueue.pop();
+      held.velocity = midiOutQueue.pop();
+      held.since = now;
+      midiHeldNoteOnCount++;
+      return true;
+    }
+  }
+  return false;
+}
+
+// takeHeldMidiNoteOn:
+// Constitutes the record of a held note on once its retrigger interval has passed, or of the note off that
+// was attached to a note on that was just sent
+boolean takeHeldMidiNoteOn(unsigned long now, byte* record, unsigned short& slot) {
+  for (byte i = 0; i < MIDI_HELD_NOTE_ONS; ++i) {
+    MidiHeldNoteOn& held = midiHeldNoteOns[i];
+    if (!held.active) continue;
+
+    if (held.noteOnSent) {
+      record[0] = held.channel;
+      record[1] = held.noteOffType;
+      record[2] = held.note;
+      record[3] = held.noteOffVelocity;
+      slot = MIDI_SLOTS_HELD + i * 2 + 1;
+      held.active = false;
+      midiHeldNoteOnCount--;
+      return true;
+    }
+
+    if (!isMidiRetriggerPending(held.channel, held.note, now)) {
+      record[0] = held.channel;
+      record[1] = MIDINoteOn;
+      record[2] = held.note;
+      record[3] = held.velocity;
+      slot = MIDI_SLOTS_HELD + i * 2;
+      midiRetriggerDelayCount++;
+      midiRetriggerDelayTotal += calcTimeDelta(now, held.since);
+      if (held.noteOffPending) {
+        held.noteOnSent = true;
+      }
+      else {
+        held.active = false;
+        midiHeldNoteOnCount--;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+void recordMidiNoteOff(byte channel, byte note, unsigned long now) {
+  MidiNoteOffMoment& entry = midiNoteOffHistory[midiNoteOffHistoryIndex];
+  entry.active = true;
+  entry.channel = channel;
+  entry.note = note;
+  entry.moment = now;
+  midiNoteOffHistoryIndex = (midiNoteOffHistoryIndex + 1) % MIDI_NOTE_OFF_HISTORY;
+}
+
+// isMidiRetriggerPending:
+// Checks whether the note off of the same note and channel was sent less than the retrigger interval ago
+boolean isMidiRetriggerPending(byte channel, byte note, unsigned long now) {
+  for (byte i = 0; i < MIDI_NOTE_OFF_HISTORY; ++i) {
+    MidiNoteOffMoment& entry = midiNoteOffHistory[i];
+    if (entry.active && entry.channel == channel && entry.note == note) {
+      if (calcTimeDelta(now, entry.moment) < midiRetriggerInterval) {
+        return true;
+      }
+      entry.active = false;
+    }
+  }
+  return false;
+}
+
+// isMidiStatusRunning:
+// Tracks the running status for each status byte that is sent and returns true when it can be left out
+boolean isMidiStatusRunning(byte status, unsigned long now) {
+  // real-time messages can be interleaved without affecting the running status
+  if (status >= MIDITimingClock) {
+    return false;
+  }
+
+  if (status >= MIDISystemExclusive || !Device.midiRunningStatus || !isMidiUsingDIN()) {
+    midiOutRunningStatus = 0;
+    return false;
+  }
+
+  if (status == midiOutRunningStatus && calcTimeDelta(now, midiOutRunningStatusMoment) < MIDI_RUNNING_STATUS_REFRESH) {
+    midiOutOmittedBytes++;
+    return true;
+  }
+
+  midiOutRunningStatus = status;
+  midiOutRunningStatusMoment = now;
+  return false;
+}
+
+// adaptMidiDecimationRate:
+// Estimates how long the current backlog of MIDI messages takes to send and adapts the decimation rate to it,
+// increasing quickly when the backlog exceeds the target latency and decreasing slowly when it's well below
+void adaptMidiDecimationRate(unsigned long now) {
+  static unsigned long lastAdaptation = 0;
+  static unsigned long lastSentMessages = 0;
+  static unsigned long lastBacklog = 0;
+
+  unsigned long elapsed = calcTimeDelta(now, lastAdaptation);
+  if (elapsed < MIDI_DECIMATION_PERIOD) {
+    return;
+  }
+  lastAdaptation = now;
+
+  expireMidiTrackedSlots(now);
+
+  unsigned long drained = midiOutSentMessages - lastSentMessages;
+  lastSentMessages = midiOutSentMessages;
+
+  unsigned long backlog = midiOutQueue.size() / 4 + midiWaitingCount;
+  if (backlog > midiOutHighWaterMark) {
+    midiOutHighWaterMark = min(backlog, (unsigned long)0xFFFF);
+  }
+
+  if (midiDecimateAdaptive) {
+    // when the backlog was there for the whole period, the link is saturated and the measured drain rate
+    // is what it can sustain, otherwise the time of a full message at the minimum interval is used
+    unsigned long messageTime = midiMinimumInterval * 3;
+    if (lastBacklog > 0 && drained > 0) {
+      messageTime = max(messageTime, elapsed / drained);
+    }
+    unsigned long latency = backlog * messageTime;
+
+    if (latency > MIDI_DECIMATION_TARGET_LATENCY) {
+      midiDecimateRate += max(midiDecimateRate / 4, (unsigned long)MIDI_DECIMATION_MINIMUM_STEP);
+    }
+    else if (latency < MIDI_DECIMATION_TARGET_LATENCY / 2) {
+      midiDecimateRate -= midiDecimateRate / 16;
+    }
+    midiDecimateRate = constrain(midiDecimateRate, midiDecimateMinimum, midiDecimateMaximum);
+  }
+
+  lastBacklog = backlog;
+}
+
+// encodeMidiMessage:
+// Writes the MIDI bytes of a four byte message record to the buffer and returns how many there are
+byte encodeMidiMessage(byte* record, byte* buffer, unsigned long now) {
+  byte type = record[1];
+  byte length = 0;
+
+  // the channel is only part of the status byte for channel messages
+  byte status = type;
+  if (type < MIDISystemExclusive) {
+    status |= record[0];
+  }
+  if (!isMidiStatusRunning(status, now)) {
+    buffer[length++] = status;
+  }
+
+  // MIDI clock and active sensing messages have no data bytes,
+  // program change and channel pressure only have one
+  switch (type) {
+    case MIDIStart:
+    case MIDIContinue:
+    case MIDIStop:
+    case MIDITimingClock:
+    case MIDIActiveSensing:
+      break;
+    case MIDIProgramChange:
+    case MIDIChannelPressure:
+      buffer[length++] = record[2];
+      break;
+    default:
+      buffer[length++] = record[2];
+      buffer[length++] = record[3];
+      break;
+  }
+
+  return length;
 }
 
 void handlePendingMidi(unsigned long now) {
   static unsigned long lastEnvoy = 0;
-  static byte inMsgIndex = 0;
-  static byte lastChannel = 0;
-  static byte lastType = 0;
-  static byte outMsgBuffer[3];
-  static byte outMsgIndex = 0;
+  static byte lastEnvoyBytes = 3;
+  static byte msgRecord[4];
+  static byte outBuffer[MIDI_BATCH_BYTES];
 
   // if there's a sysex message ready to be sent out, do that first
   if (!sysexOutQueue.empty()) {
-    while (Serial.availableForWrite()) {
+    while (!sysexOutQueue.empty() && Serial.availableForWrite()) {
       Serial.write(sysexOutQueue.pop());
     }
+    midiOutRunningStatus = 0;
     return;
   }
 
-  // when there are MIDI messages queued and the serial queue has room
-  // for at least one full MIDI message start sending it out
-  if (!midiOutQueue.empty() && Serial.availableForWrite() > 3) {
-    // the first queued byte is always the MIDI channel
-    if (inMsgIndex == 0) {
-      lastChannel = midiOutQueue.pop();
-      inMsgIndex++;
+  adaptMidiDecimationRate(now);
+
+  // determine how many bytes can be written now
+  int budget = 0;
+  if (Device.midiBatchedWrites) {
+    // the bytes that the minimum interval allows since the last write can be sent in one burst,
+    // the credit that builds up while idle is limited to a few messages so that the average interval is honored
+    unsigned long credit = midiMinimumInterval * MIDI_BATCH_CREDIT;
+    if (calcTimeDelta(now, lastEnvoy) > credit) {
+      lastEnvoy = now - credit;
+    }
+    if (midiMinimumInterval == 0) {
+      budget = MIDI_BATCH_BYTES;
     }
-    // the others will constitute the actual MIDI message
     else {
-      byte nextByte = midiOutQueue.peek();
-
-      // always insert a 1 ms delay around MIDI note on and note off boundaries
-      unsigned long additionalInterval = 0;
-      if (inMsgIndex == 1 &&
-          (lastType == MIDINoteOn ||
-           nextByte == MIDINoteOff || lastType == MIDINoteOff)) {
-        additionalInterval = 2000;
-      }
-
-      // if the time between now and the last MIDI message exceeds the required interval, process it
-      if (calcTimeDelta(now, lastEnvoy) >= (midiMinimumInterval * 3 + additionalInterval)) {
-        // construct the correct MIDI byte that needs to be sent
-        byte midiByte;
-        if (inMsgIndex == 1) {
-          midiByte = nextByte | lastChannel;
-        }
-        else {
-          midiByte = nextByte;
-        }
-
-        // add the MIDI message byte to the buffer
-        outMsgBuffer[outMsgIndex++] = midiByte;
-
-        // keep track of the last MIDI message type that was handled
-        if (inMsgIndex == 1) {
-          lastType = nextByte;
-        }
+      budget = calcTimeDelta(now, lastEnvoy) / midiMinimumInterval;
+    }
+    budget = min(budget, Serial.availableForWrite());
+  }
+  // otherwise a single message is sent when the time since the previous one exceeds the required interval
+  else if (Serial.availableForWrite() > 3 && calcTimeDelta(now, lastEnvoy) >= midiMinimumInterval * lastEnvoyBytes) {
+    budget = 3;
+  }
 
-        // remove the sent byte from the queue and keep track of the message sequence
-        midiOutQueue.pop();
-        inMsgIndex++;
-
-        // in case of MIDI clock messages, the MIDI message length is two shorter,
-        // so automatically remove the third and fourth byte from the queue since it's unused
-        if (inMsgIndex == 2 &&
-            (lastType == MIDIStart || lastType == MIDIContinue || lastType == MIDIStop || lastType == MIDITimingClock)) {
-          midiOutQueue.pop();
-          midiOutQueue.pop();
-          inMsgIndex += 2;
-        }
-        // in case of program change and channel pressure, the MIDI message length is one shorter,
-        // so automatically remove the fourth byte from the queue since it's unused
-        else if (inMsgIndex == 3 &&
-                 (lastType == MIDIProgramChange || lastType == MIDIChannelPressure)) {
-          midiOutQueue.pop();
-          inMsgIndex++;
-        }
+  // constitute as many full MIDI messages as the budget allows
+  int length = 0;
+  while (budget - length >= 3) {
+    unsigned short msgSlot;
+    if (!takeNextMidiMessage(now, msgRecord, msgSlot)) {
+      if (midiOutQueue.empty()) {
+        resyncMidiLatencyTraces();
       }
+      break;
     }
 
-    // each time four bytes have been processed from the queue, start a new MIDI message
-    if (inMsgIndex == 4) {
-      // write the MIDI message in its entirety to the serial port
-      Serial.write(outMsgBuffer, outMsgIndex);
+    length += encodeMidiMessage(msgRecord, &outBuffer[length], now);
+    midiOutSentMessages++;
 
-      inMsgIndex = 0;
-      lastChannel = 0;
-      outMsgIndex = 0;
+    if (msgSlot == MIDI_SLOTS_COUNT) {
+      traceSentMidiMessage(micros());
+    }
+    else {
+      traceSentMidiSlot(msgSlot, micros());
+    }
+    if (msgRecord[1] == MIDINoteOff || (msgRecord[1] == MIDINoteOn && msgRecord[3] == 0)) {
+      recordMidiNoteOff(msgRecord[0], msgRecord[2], now);
+    }
 
-      // update the last time a MIDI message was sent
-      lastEnvoy = now;
+    if (!Device.midiBatchedWrites) {
+      break;
     }
   }
+
+  if (length == 0) {
+    return;
+  }
+
+  // write the MIDI messages in their entirety to the serial port
+  Serial.write(outBuffer, length);
+  midiOutWrittenBytes += length;
+
+  // keep track of the moment up to which the written bytes used up the interval
+  if (Device.midiBatchedWrites) {
+    lastEnvoy += midiMinimumInterval * length;
+  }
+  else {
+    // the interval before the next message follows the number of bytes that were actually written
+    lastEnvoyBytes = length;
+    lastEnvoy = now;
+  }
 }
 
 void preSendFader(byte split, byte v) {
@@ -2519,37 +3718,26 @@ void midiSendAllNotesOff(byte split) {
   preSendControlChange(split, 123, 0, true);
 
   preSendControlChange(split, 64, 0, true);
-  for (byte notenum = 0; notenum < 128; ++notenum) {
-    switch (Split[split].midiMode) {
-      case channelPerNote:
-      {
-        for (byte ch = 0; ch < 16; ++ch) {
-          if (Split[split].midiChanSet[ch]) {
-            midiSendNoteOffRaw(notenum, 0x40, ch);
-          }
-        }
-        break;
-      }
 
-      case channelPerRow:
-      {
-        for ( byte row = 0; row < NUMROWS; ++row) {
-          byte ch = Split[split].midiChanPerRow + row;
-          if (ch > 16) {
-            ch -= 16;
-          }
-          midiSendNoteOffRaw(notenum, 0x40, ch-1);
+  // only the notes that are on need an explicit note off, these are found by iterating over the set bits,
+  // the notes whose note off couldn't be queued stay on so that they're not forgotten
+  for (byte ch = 0; ch < 16; ++ch) {
+    for (byte w = 0; w < 4; ++w) {
+      unsigned long notesOn = midiNotesOn[split][ch][w];
+      while (notesOn) {
+        byte bit = 31 - __builtin_clz(notesOn);
+        notesOn &= ~(1UL << bit);
+        if (midiSendNoteOffRaw((w << 5) + bit, 0x40, ch)) {
+          midiNotesOn[split][ch][w] &= ~(1UL << bit);
         }
-        break;
-      }
-
-      case oneChannel:
-      {
-        midiSendNoteOffRaw(notenum, 0x40, Split[split].midiChanMain-1);
-        break;
       }
     }
   }
+  for (byte i = 0; i < MIDI_STACKED_NOTES; ++i) {
+    if (stackedMidiNotes[i].split == split) {
+      stackedMidiNotes[i].count = 0;
+    }
+  }
 }
 
 void midiSendControlChange(byte controlnum, byte controlval, byte channel) {
@@ -2561,14 +3749,12 @@ void midiSendControlChange(byte controlnum, byte controlval, byte channel, boole
   controlval = constrain(controlval, 0, 127);
   channel = constrain(channel-1, 0, 15);
 
-  unsigned long now = micros();
-  // always send channel mode messages and sustain, as well as messages that are flagged as always
-  if (!always && controlnum < 120 && controlnum != 64) {
-    if (lastValueMidiCC[channel][controlnum] == controlval) return;
-    if (controlval != 0 && calcTimeDelta(now, lastMomentMidiCC[channel][controlnum]) <= midiDecimateRate) return;
-  }
-  lastValueMidiCC[channel][controlnum] = controlval;
-  lastMomentMidiCC[channel][controlnum] = now;
+  // always send channel mode messages and sustain, as well as messages that are flagged as always,
+  // these are queued in order while the others are continuous data that only needs its latest value sent
+  boolean continuous = (!always && controlnum < 120 && controlnum != 64);
+  unsigned short slot = getMidiSlot(MIDIControlChange, controlnum, channel);
+  if (continuous && getLastMidiValue(slot) == controlval) return;
+  setLastMidiValue(slot, controlval);
 
   if (Device.serialMode) {
 #ifdef DEBUG_ENABLED
@@ -2583,7 +3769,11 @@ void midiSendControlChange(byte controlnum, byte controlval, byte channel, boole
     }
 #endif
   }
+  else if (continuous) {
+    queueContinuousMidiMessage(MIDIControlChange, controlnum, controlval, channel);
+  }
   else {
+    cancelContinuousMidiMessage(MIDIControlChange, controlnum, channel);
     queueMidiMessage(MIDIControlChange, controlnum, controlval, channel);
   }
 }
@@ -2594,20 +3784,15 @@ void midiSendControlChange14BitUserFirmware(byte controlMsb, byte controlLsb, sh
   controlval = constrain(controlval, 0, 0x3fff);
   channel = constrain(channel-1, 0, 15);
 
-  unsigned long now = micros();
-
   // calculate the 14-bit msb and lsb
   unsigned msb = (controlval & 0x3fff) >> 7;
   unsigned lsb = controlval & 0x7f;
 
-  if (lastValueMidiCC[channel][controlMsb] == msb && lastValueMidiCC[channel][controlLsb] == lsb) return;
-  if (controlval != 0 &&
-      (calcTimeDelta(now, lastMomentMidiCC[channel][controlMsb]) <= midiDecimateRate ||
-       calcTimeDelta(now, lastMomentMidiCC[channel][controlLsb]) <= midiDecimateRate)) return;
-  lastValueMidiCC[channel][controlMsb] = msb;
-  lastMomentMidiCC[channel][controlMsb] = now;
-  lastValueMidiCC[channel][controlLsb] = lsb;
-  lastMomentMidiCC[channel][controlLsb] = now;
+  unsigned short slotMsb = getMidiSlot(MIDIControlChange, controlMsb, channel);
+  unsigned short slotLsb = getMidiSlot(MIDIControlChange, controlLsb, channel);
+  if (getLastMidiValue(slotMsb) == msb && getLastMidiValue(slotLsb) == lsb) return;
+  setLastMidiValue(slotMsb, msb);
+  setLastMidiValue(slotLsb, lsb);
 
   if (Device.serialMode) {
 #ifdef DEBUG_ENABLED
@@ -2625,8 +3810,8 @@ void midiSendControlChange14BitUserFirmware(byte controlMsb, byte controlLsb, sh
 #endif
   }
   else {
-    queueMidiMessage(MIDIControlChange, controlLsb, lsb, channel);
-    queueMidiMessage(MIDIControlChange, controlMsb, msb, channel);
+    queueContinuousMidiMessage(MIDIControlChange, controlLsb, lsb, channel);
+    queueContinuousMidiMessage(MIDIControlChange, controlMsb, msb, channel);
   }
 }
 
@@ -2636,16 +3821,13 @@ void midiSendControlChange14BitMIDISpec(byte controlMsb, byte controlLsb, short
   controlval = constrain(controlval, 0, 0x3fff);
   channel = constrain(channel-1, 0, 15);
 
-  unsigned long now = micros();
-
   // calculate the 14-bit msb and lsb
   unsigned msb = (controlval & 0x3fff) >> 7;
   unsigned lsb = controlval & 0x7f;
 
-  if (lastValueMidiCC[channel][controlMsb] == msb && lastValueMidiCC[channel][controlLsb] == lsb) return;
-  if (controlval != 0 &&
-      (calcTimeDelta(now, lastMomentMidiCC[channel][controlMsb]) <= midiDecimateRate ||
-       calcTimeDelta(now, lastMomentMidiCC[channel][controlLsb]) <= midiDecimateRate)) return;
+  unsigned short slotMsb = getMidiSlot(MIDIControlChange, controlMsb, channel);
+  unsigned short slotLsb = getMidiSlot(MIDIControlChange, controlLsb, channel);
+  if (getLastMidiValue(slotMsb) == msb && getLastMidiValue(slotLsb) == lsb) return;
   if (Device.serialMode) {
 #ifdef DEBUG_ENABLED
     if (SWITCH_DEBUGMIDI) {
@@ -2662,14 +3844,85 @@ void midiSendControlChange14BitMIDISpec(byte controlMsb, byte controlLsb, short
 #endif
   }
   else {
-    if (lastValueMidiCC[channel][controlMsb] != msb) {
-      lastValueMidiCC[channel][controlMsb] = msb;
-      lastMomentMidiCC[channel][controlMsb] = now;
-      queueMidiMessage(MIDIControlChange, controlMsb, msb, channel);
+    if (getLastMidiValue(slotMsb) != msb) {
+      setLastMidiValue(slotMsb, msb);
+      queueContinuousMidiMessage(MIDIControlChange, controlMsb, msb, channel);
+    }
+    setLastMidiValue(slotLsb, lsb);
+    queueContinuousMidiMessage(MIDIControlChange, controlLsb, lsb, channel);
+  }
+}
+
+// Active MIDI note tracking:
+// A note that's on has its bit set in midiNotesOn, additional note ons of the same note are counted in
+// stackedMidiNotes. When that pool is full, the additional note on isn't counted and the first note off
+// releases the note, which ends it on the receiver anyway.
+inline boolean isMidiNoteOn(byte split, byte notenum, byte channel) {
+  return midiNotesOn[split][channel][notenum >> 5] & (1UL << (notenum & 0x1F));
+}
+
+short findStackedMidiNote(byte split, byte notenum, byte channel) {
+  for (byte i = 0; i < MIDI_STACKED_NOTES; ++i) {
+    if (stackedMidiNotes[i].count > 0 && stackedMidiNotes[i].split == split &&
+        stackedMidiNotes[i].note == notenum && stackedMidiNotes[i].channel == channel) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void holdMidiNote(byte split, byte notenum, byte channel) {
+  if (!isMidiNoteOn(split, notenum, channel)) {
+    midiNotesOn[split][channel][notenum >> 5] |= (1UL << (notenum & 0x1F));
+    return;
+  }
+
+  short stacked = findStackedMidiNote(split, notenum, channel);
+  if (stacked >= 0) {
+    if (stackedMidiNotes[stacked].count < 0xFF) {
+      stackedMidiNotes[stacked].count++;
+    }
+    return;
+  }
+
+  for (byte i = 0; i < MIDI_STACKED_NOTES; ++i) {
+    if (stackedMidiNotes[i].count == 0) {
+      stackedMidiNotes[i].split = split;
+      stackedMidiNotes[i].note = notenum;
+      stackedMidiNotes[i].channel = channel;
+      stackedMidiNotes[i].count = 1;
+      return;
+    }
+  }
+}
+
+// releaseMidiNote:
+// Returns true when the note was on and a note off needs to be sent
+boolean releaseMidiNote(byte split, byte notenum, byte channel) {
+  if (!isMidiNoteOn(split, notenum, channel)) {
+    return false;
+  }
+
+  short stacked = findStackedMidiNote(split, notenum, channel);
+  if (stacked >= 0) {
+    stackedMidiNotes[stacked].count--;
+  }
+  else {
+    midiNotesOn[split][channel][notenum >> 5] &= ~(1UL << (notenum & 0x1F));
+  }
+  return true;
+}
+
+void clearMidiNotesOn(byte split) {
+  for (byte c = 0; c < 16; ++c) {
+    for (byte w = 0; w < 4; ++w) {
+      midiNotesOn[split][c][w] = 0;
+    }
+  }
+  for (byte i = 0; i < MIDI_STACKED_NOTES; ++i) {
+    if (stackedMidiNotes[i].split == split) {
+      stackedMidiNotes[i].count = 0;
     }
-    lastValueMidiCC[channel][controlLsb] = lsb;
-    lastMomentMidiCC[channel][controlLsb] = now;
-    queueMidiMessage(MIDIControlChange, controlLsb, lsb, channel);
   }
 }
 
@@ -2679,7 +3932,7 @@ void midiSendNoteOn(byte split, byte notenum, byte velocity, byte channel) {
   velocity = constrain(velocity, 0, 127);
   channel = constrain(channel-1, 0, 15);
 
-  lastValueMidiNotesOn[split][notenum][channel]++;
+  holdMidiNote(split, notenum, channel);
 
   if (Device.serialMode) {
 #ifdef DEBUG_ENABLED
@@ -2694,8 +3947,8 @@ void midiSendNoteOn(byte split, byte notenum, byte velocity, byte channel) {
     }
 #endif
   }
-  else {
-    queueMidiMessage(MIDINoteOn, notenum, velocity, channel);
+  else if (!queueMidiMessage(MIDINoteOn, notenum, velocity, channel)) {
+    releaseMidiNote(split, notenum, channel);
   }
 }
 
@@ -2703,7 +3956,7 @@ boolean hasActiveMidiNote(byte split, byte notenum, byte channel) {
   split = constrain(split, 0, 1);
   notenum = constrain(notenum, 0, 127);
   channel = constrain(channel-1, 0, 15);
-  return lastValueMidiNotesOn[split][notenum][channel] > 0;
+  return isMidiNoteOn(split, notenum, channel);
 }
 
 void midiSendNoteOff(byte split, byte notenum, byte channel) {
@@ -2711,9 +3964,10 @@ void midiSendNoteOff(byte split, byte notenum, byte channel) {
   notenum = constrain(notenum, 0, 127);
   channel = constrain(channel-1, 0, 15);
 
-  if (lastValueMidiNotesOn[split][notenum][channel] > 0) {
-      lastValueMidiNotesOn[split][notenum][channel]--;
-    midiSendNoteOffRaw(notenum, 0x40, channel);
+  // the note is tracked again when its note off couldn't be queued, the next all notes off will then catch it
+  if (releaseMidiNote(split, notenum, channel) &&
+      !midiSendNoteOffRaw(notenum, 0x40, channel)) {
+    holdMidiNote(split, notenum, channel);
   }
 }
 
@@ -2722,13 +3976,16 @@ void midiSendNoteOffWithVelocity(byte split, byte notenum, byte velocity, byte c
   notenum = constrain(notenum, 0, 127);
   channel = constrain(channel-1, 0, 15);
 
-  if (lastValueMidiNotesOn[split][notenum][channel] > 0) {
-      lastValueMidiNotesOn[split][notenum][channel]--;
-    midiSendNoteOffRaw(notenum, velocity, channel);
+  // the note is tracked again when its note off couldn't be queued, the next all notes off will then catch it
+  if (releaseMidiNote(split, notenum, channel) &&
+      !midiSendNoteOffRaw(notenum, velocity, channel)) {
+    holdMidiNote(split, notenum, channel);
   }
 }
 
-void midiSendNoteOffRaw(byte notenum, byte velocity, byte channel) {
+// midiSendNoteOffRaw:
+// Returns false when the note off couldn't be queued
+boolean midiSendNoteOffRaw(byte notenum, byte velocity, byte channel) {
   if (Device.serialMode) {
 #ifdef DEBUG_ENABLED
     if (SWITCH_DEBUGMIDI) {
@@ -2741,8 +3998,9 @@ void midiSendNoteOffRaw(byte notenum, byte velocity, byte channel) {
 #endif
   }
   else {
-    queueMidiMessage(MIDINoteOff, notenum, velocity, channel);
+    return queueMidiMessage(MIDINoteOff, notenum, velocity, channel);
   }
+  return true;
 }
 
 void midiSendNoteOffForAllTouches(byte split) {
@@ -2774,11 +4032,8 @@ void midiSendPitchBend(int pitchval, byte channel) {
   int bend = constrain(pitchval + 0x2000, 0, 16383);
   channel = constrain(channel-1, 0, 15);
 
-  unsigned long now = micros();
   if (lastValueMidiPB[channel] == bend) return;
-  if (pitchval != 0 && calcTimeDelta(now, lastMomentMidiPB[channel]) <= midiDecimateRate) return;
   lastValueMidiPB[channel] = bend;
-  lastMomentMidiPB[channel] = now;
 
   if (Device.serialMode) {
 #ifdef DEBUG_ENABLED
@@ -2792,7 +4047,7 @@ void midiSendPitchBend(int pitchval, byte channel) {
 #endif
   }
   else {
-    queueMidiMessage(MIDIPitchBend, bend & 0x7F, (bend >> 7) & 0x7F, channel);
+    queueContinuousMidiMessage(MIDIPitchBend, bend & 0x7F, (bend >> 7) & 0x7F, channel);
   }
 }
 
@@ -2822,13 +4077,8 @@ void midiSendAfterTouch(byte value, byte channel, boolean always) {
   value = constrain(value, 0, 127);
   channel = constrain(channel-1, 0, 15);
 
-  unsigned long now = micros();
-  if (!always) {
-    if (lastValueMidiAT[channel] == value) return;
-    if (value != 0 && calcTimeDelta(now, lastMomentMidiAT[channel]) <= midiDecimateRate) return;
-  }
+  if (!always && lastValueMidiAT[channel] == value) return;
   lastValueMidiAT[channel] = value;
-  lastMomentMidiAT[channel] = now;
 
   if (Device.serialMode) {
     if (SWITCH_DEBUGMIDI && debugLevel >= 0) {
@@ -2839,7 +4089,11 @@ void midiSendAfterTouch(byte value, byte channel, boolean always) {
       Serial.print("\n");
     }
   }
+  else if (!always) {
+    queueContinuousMidiMessage(MIDIChannelPressure, value, 0, channel);
+  }
   else {
+    cancelContinuousMidiMessage(MIDIChannelPressure, 0, channel);
     queueMidiMessage(MIDIChannelPressure, value, 0, channel);
   }
 }
@@ -2850,11 +4104,9 @@ void midiSendPolyPressure(byte notenum, byte value, byte channel) {
   value = constrain(value, 0, 127);
   channel = constrain(channel-1, 0, 15);
 
-  unsigned long now = micros();
-  if (lastValueMidiPP[channel][notenum] == value) return;
-  if (value != 0 && calcTimeDelta(now, lastMomentMidiPP[channel][notenum]) <= midiDecimateRate) return;
-  lastValueMidiPP[channel][notenum] = value;
-  lastMomentMidiPP[channel][notenum] = now;
+  unsigned short slot = getMidiSlot(MIDIPolyphonicPressure, notenum, channel);
+  if (getLastMidiValue(slot) == value) return;
+  setLastMidiValue(slot, value);
 
   if (Device.serialMode) {
     if (SWITCH_DEBUGMIDI && debugLevel >= 0) {
@@ -2868,7 +4120,7 @@ void midiSendPolyPressure(byte notenum, byte value, byte channel) {
     }
   }
   else {
-    queueMidiMessage(MIDIPolyphonicPressure, notenum, value, channel);
+    queueContinuousMidiMessage(MIDIPolyphonicPressure, notenum, value, channel);
   }
 }
 
@@ -2896,6 +4148,10 @@ void midiSendNRPN(unsigned short number, unsigned short value, byte channel) {
     unsigned valueMsb = (value & 0x3fff) >> 7;
     unsigned valueLsb = value & 0x7f;
 
+    if (!reserveMidiMessages(6)) {
+      return;
+    }
+
     queueMidiMessage(MIDIControlChange, 99, numberMsb, channel);
     queueMidiMessage(MIDIControlChange, 98, numberLsb, channel);
     queueMidiMessage(MIDIControlChange, 6, valueMsb, channel);
@@ -2929,6 +4185,10 @@ void midiSendRPN(unsigned short number, unsigned short value, byte channel) {
     unsigned valueMsb = (value & 0x3fff) >> 7;
     unsigned valueLsb = value & 0x7f;
 
+    if (!reserveMidiMessages(6)) {
+      return;
+    }
+
     queueMidiMessage(MIDIControlChange, 101, numberMsb, channel);
     queueMidiMessage(MIDIControlChange, 100, numberLsb, channel);
     queueMidiMessage(MIDIControlChange, 6, valueMsb, channel);
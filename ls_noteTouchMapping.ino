@@ -18,6 +18,8 @@ that initiated the notes. Additionally, the notes also keep track of the order i
 notes were pressed but with a different channel.
 This entire structure is intended to be used by the arpeggiator, requiring a minimal amount of
 iteration to constitute the arpeggiated sequence.
+Only the active notes take an entry from a fixed pool, a hash of the note and channel finds an entry
+in constant time and a sorted index of the entries finds where a new note goes in the sequence.
 **************************************************************************************************/
 
 void resetAllTouches() {
@@ -90,14 +92,18 @@ void NoteTouchMapping::initialize(byte mappedSplit) {
   firstChannel = -1;
   lastNote = -1;
   lastChannel = -1;
-  for (byte c = 0; c < 16; ++c) {
-    for (byte n = 0; n < 128; ++n) {
-      mapping[n][c].colRow = 0;
-      mapping[n][c].nextNote = -1;
-      mapping[n][c].previousNote = -1;
-      mapping[n][c].nextPreviousChannel = 0;
-    }
-    performContinuousTasks();
+  for (byte i = 0; i < NOTE_TOUCH_CAPACITY; ++i) {
+    entries[i].note = -1;
+    entries[i].channel = -1;
+    entries[i].colRow = 0;
+    entries[i].nextNote = -1;
+    entries[i].previousNote = -1;
+    entries[i].nextPreviousChannel = 0;
+    freeEntries[i] = NOTE_TOUCH_CAPACITY - 1 - i;
+  }
+  freeCount = NOTE_TOUCH_CAPACITY;
+  for (unsigned short b = 0; b < NOTE_TOUCH_HASH_SIZE; ++b) {
+    buckets[b] = NOTE_TOUCH_NONE;
   }
   for (byte c = 0; c < 16; ++c) {
     musicalTouchCount[c] = 0;
@@ -105,6 +111,68 @@ void NoteTouchMapping::initialize(byte mappedSplit) {
   performContinuousTasks();
 }
 
+inline byte NoteTouchMapping::hashNote(signed char noteNum, signed char noteChannel) {
+  // multiplicative hash of the combined 11-bit note and channel key
+  unsigned long key = ((unsigned long)noteNum << 4) | ((noteChannel - 1) & 0x0F);
+  return ((key * 2654435761UL) >> 24) & (NOTE_TOUCH_HASH_SIZE - 1);
+}
+
+short NoteTouchMapping::findEntry(signed char noteNum, signed char noteChannel) {
+  byte b = hashNote(noteNum, noteChannel);
+  while (buckets[b] != NOTE_TOUCH_NONE) {
+    NoteEntry& entry = entries[buckets[b]];
+    if (entry.note == noteNum && entry.channel == noteChannel) {
+      return buckets[b];
+    }
+    b = (b + 1) & (NOTE_TOUCH_HASH_SIZE - 1);
+  }
+  return -1;
+}
+
+void NoteTouchMapping::removeEntry(byte index) {
+  NoteEntry& removed = entries[index];
+
+  // remove the entry from the hash buckets, shifting back the entries that follow it in the probe sequence
+  // so that no lookup stops early at the emptied bucket
+  byte b = hashNote(removed.note, removed.channel);
+  while (buckets[b] != index) {
+    b = (b + 1) & (NOTE_TOUCH_HASH_SIZE - 1);
+  }
+  byte next = (b + 1) & (NOTE_TOUCH_HASH_SIZE - 1);
+  while (buckets[next] != NOTE_TOUCH_NONE) {
+    byte home = hashNote(entries[buckets[next]].note, entries[buckets[next]].channel);
+    if (((next - home) & (NOTE_TOUCH_HASH_SIZE - 1)) >= ((next - b) & (NOTE_TOUCH_HASH_SIZE - 1))) {
+      buckets[b] = buckets[next];
+      b = next;
+    }
+    next = (next + 1) & (NOTE_TOUCH_HASH_SIZE - 1);
+  }
+  buckets[b] = NOTE_TOUCH_NONE;
+
+  // remove the entry from the sorted index, the entries of the same note are few and adjacent
+  byte lo = 0;
+  byte hi = noteCount;
+  while (lo < hi) {
+    byte mid = (lo + hi) / 2;
+    if (entries[sortedEntries[mid]].note < removed.note) lo = mid + 1;
+    else hi = mid;
+  }
+  while (lo < noteCount && sortedEntries[lo] != index) {
+    ++lo;
+  }
+  if (lo < noteCount) {
+    memmove(&sortedEntries[lo], &sortedEntries[lo + 1], noteCount - lo - 1);
+  }
+
+  removed.note = -1;
+  removed.channel = -1;
+  removed.colRow = 0;
+  removed.nextNote = -1;
+  removed.previousNote = -1;
+  removed.nextPreviousChannel = 0;
+  freeEntries[freeCount++] = index;
+}
+
 void NoteTouchMapping::releaseLatched() {
   DEBUGPRINT((1,"releaseLatched"));
   DEBUGPRINT((1,"\n"));
@@ -112,7 +180,7 @@ void NoteTouchMapping::releaseLatched() {
   signed char entryNote = firstNote;
   signed char entryChannel = firstChannel;
   while (entryNote != -1) {
-    NoteEntry& entry = mapping[entryNote][entryChannel-1];
+    NoteEntry& entry = *getNoteEntry(entryNote, entryChannel);
     signed char nextNote = entry.getNextNote();
     signed char nextChannel = entry.getNextChannel();
 
@@ -145,7 +213,12 @@ inline NoteEntry* NoteTouchMapping::getNoteEntry(signed char noteNum, signed cha
     return NULL;
   }
 
-  return &mapping[noteNum][noteChannel - 1];
+  short index = findEntry(noteNum, noteChannel);
+  if (index < 0) {
+    return NULL;
+  }
+
+  return &entries[index];
 }
 
 boolean NoteTouchMapping::hasTouch(signed char noteNum, signed char noteChannel) {
@@ -153,7 +226,7 @@ boolean NoteTouchMapping::hasTouch(signed char noteNum, signed char noteChannel)
     return false;
   }
 
-  return mapping[noteNum][noteChannel - 1].colRow != 0;
+  return findEntry(noteNum, noteChannel) >= 0;
 }
 
 void NoteTouchMapping::noteOn(signed char noteNum, signed char noteChannel, byte col, byte row) {
@@ -166,75 +239,68 @@ void NoteTouchMapping::noteOn(signed char noteNum, signed char noteChannel, byte
 
   musicalTouchCount[channel] += 1;
 
-  if (!mapping[noteNum][channel].hasTouch()) {
-    noteCount++;
+  short index = findEntry(noteNum, noteChannel);
+  if (index < 0) {
+    // when all the entries are in use, the note plays but isn't available to the arpeggiator
+    if (freeCount == 0) {
+      return;
+    }
+
+    index = freeEntries[--freeCount];
+    NoteEntry& added = entries[index];
+    added.note = noteNum;
+    added.channel = noteChannel;
 
-    // no notes are in the chain yet, add this one as the first note
-    if (-1 == firstNote) {
+    byte b = hashNote(noteNum, noteChannel);
+    while (buckets[b] != NOTE_TOUCH_NONE) {
+      b = (b + 1) & (NOTE_TOUCH_HASH_SIZE - 1);
+    }
+    buckets[b] = index;
+
+    // find the position in the sorted index after all the entries of the same or lower notes,
+    // this gives earlier presses of the same note precedence
+    byte pos = 0;
+    byte hi = noteCount;
+    while (pos < hi) {
+      byte mid = (pos + hi) / 2;
+      if (entries[sortedEntries[mid]].note <= noteNum) pos = mid + 1;
+      else hi = mid;
+    }
+
+    // link the new entry in between its neighbours in the sorted index
+    if (pos > 0) {
+      NoteEntry& previous = entries[sortedEntries[pos - 1]];
+      added.previousNote = previous.note;
+      added.setPreviousChannel(previous.channel);
+      previous.nextNote = noteNum;
+      previous.setNextChannel(noteChannel);
+    }
+    else {
+      added.previousNote = -1;
+      added.setPreviousChannel(0);
       firstNote = noteNum;
       firstChannel = noteChannel;
+    }
+    if (pos < noteCount) {
+      NoteEntry& next = entries[sortedEntries[pos]];
+      added.nextNote = next.note;
+      added.setNextChannel(next.channel);
+      next.previousNote = noteNum;
+      next.setPreviousChannel(noteChannel);
+    }
+    else {
+      added.nextNote = -1;
+      added.setNextChannel(0);
       lastNote = noteNum;
       lastChannel = noteChannel;
-      mapping[noteNum][channel].nextNote = -1;
-      mapping[noteNum][channel].previousNote = -1;
-      mapping[noteNum][channel].nextPreviousChannel = 0;
     }
-    else {
-      signed char entryNote = firstNote;
-      signed char entryChannel = firstChannel;
-      while (entryNote != -1) {
-        NoteEntry& entry = mapping[entryNote][entryChannel - 1];
-
-        // the current note entry comes after the new note, we'll insert the new note
-        // right before the current note entry
-        // this solves two scenarios, first it will add the new note as a last channel in the chain
-        // if this note already exists (ie. earlier presses of the same note get precedence),
-        // and it will slide in a new note entry between existing ones if the note didn't exist before
-        if (entryNote > noteNum) {
-          signed char prevNote = entry.previousNote;
-          signed char prevChannel = entry.getPreviousChannel();
-
-          mapping[noteNum][channel].nextNote = entryNote;
-          mapping[noteNum][channel].setNextChannel(entryChannel);
-          mapping[noteNum][channel].previousNote = entry.previousNote;
-          mapping[noteNum][channel].setPreviousChannel(entry.getPreviousChannel());
-          entry.previousNote = noteNum;
-          entry.setPreviousChannel(noteChannel);
-
-          // handle the case where the current note entry is the first in the chain
-          if (-1 == prevNote) {
-            firstNote = noteNum;
-            firstChannel = noteChannel;
-          }
-          else {
-            mapping[prevNote][prevChannel - 1].nextNote = noteNum;
-            mapping[prevNote][prevChannel - 1].setNextChannel(noteChannel);
-          }
-
-          break;
-        }
 
-        // this is the last note in the chain, but it still comes before the new one,
-        // insert the new note after this one
-        if (entry.nextNote == -1) {
-          lastNote = noteNum;
-          lastChannel = noteChannel;
-          mapping[noteNum][channel].nextNote = -1;
-          mapping[noteNum][channel].setNextChannel(0);
-          mapping[noteNum][channel].previousNote = entryNote;
-          mapping[noteNum][channel].setPreviousChannel(entryChannel);
-          entry.nextNote = noteNum;
-          entry.setNextChannel(noteChannel);
-          break;
-        }
-
-        entryNote = entry.nextNote;
-        entryChannel = entry.getNextChannel();
-      }
-    }
+    memmove(&sortedEntries[pos + 1], &sortedEntries[pos], noteCount - pos);
+    sortedEntries[pos] = index;
+    noteCount++;
   }
 
-  mapping[noteNum][channel].setColRow(col, row);
+  entries[index].setColRow(col, row);
 
   // this note on is the same as the currently playing note, restore the arp step to this note
   if (!isSwitchLegatoPressed(split) && !isSwitchLatchPressed(split)) {
@@ -262,31 +328,33 @@ void NoteTouchMapping::noteOff(signed char noteNum, signed char noteChannel) {
 
   musicalTouchCount[channel] -= 1;
 
-  if (hasTouch(noteNum, noteChannel)) {
-    noteCount--;
+  short index = findEntry(noteNum, noteChannel);
+  if (index >= 0) {
+    NoteEntry& removed = entries[index];
 
     // if this is the first note that is active, point the first note/channel
     // markers to the next note entry in the chain and adapt this entry's
     // previous information
     if (firstNote == noteNum && firstChannel == noteChannel) {
-      firstNote = mapping[noteNum][channel].nextNote;
-      firstChannel = mapping[noteNum][channel].getNextChannel();
+      firstNote = removed.nextNote;
+      firstChannel = removed.getNextChannel();
       if (firstNote == -1) {
         lastNote = -1;
         lastChannel = -1;
       }
       else {
-        mapping[firstNote][firstChannel - 1].previousNote = -1;
-        mapping[firstNote][firstChannel - 1].setPreviousChannel(0);
+        NoteEntry* first = getNoteEntry(firstNote, firstChannel);
+        first->previousNote = -1;
+        first->setPreviousChannel(0);
       }
     }
     // simply remove this note entry from the chain by pointing the previous and
     // next note entries to each-other
     else {
-      signed char prevNote = mapping[noteNum][channel].previousNote;
-      signed char prevChannel = mapping[noteNum][channel].getPreviousChannel();
-      signed char nxtNote = mapping[noteNum][channel].nextNote;
-      signed char nxtChannel = mapping[noteNum][channel].getNextChannel();
+      signed char prevNote = removed.previousNote;
+      signed char prevChannel = removed.getPreviousChannel();
+      signed char nxtNote = removed.nextNote;
+      signed char nxtChannel = removed.getNextChannel();
       
       // verify if the removed note entry is the current active arp step, if that's
       // the case, update the step so that linked chain of notes is not interrupted
@@ -308,23 +376,23 @@ void NoteTouchMapping::noteOff(signed char noteNum, signed char noteChannel) {
       }
 
       // update the next and previous entries
-      mapping[prevNote][prevChannel - 1].nextNote = nxtNote;
-      mapping[prevNote][prevChannel - 1].setNextChannel(nxtChannel);
+      NoteEntry* previous = getNoteEntry(prevNote, prevChannel);
+      previous->nextNote = nxtNote;
+      previous->setNextChannel(nxtChannel);
       if (nxtNote == -1) {
         lastNote = prevNote;
         lastChannel = prevChannel;
       }
       else {
-        mapping[nxtNote][nxtChannel - 1].previousNote = prevNote;
-        mapping[nxtNote][nxtChannel - 1].setPreviousChannel(prevChannel);
+        NoteEntry* next = getNoteEntry(nxtNote, nxtChannel);
+        next->previousNote = prevNote;
+        next->setPreviousChannel(prevChannel);
       }
     }
 
-    // reset all the data of this note entry
-    mapping[noteNum][channel].colRow = 0;
-    mapping[noteNum][channel].nextNote = -1;
-    mapping[noteNum][channel].previousNote = -1;
-    mapping[noteNum][channel].nextPreviousChannel = 0;
+    // reset all the data of this note entry and return it to the pool
+    removeEntry(index);
+    noteCount--;
   }
 
   DEBUGPRINT((1,"noteOff"));
@@ -340,11 +408,9 @@ void NoteTouchMapping::changeCell(signed char noteNum, signed char noteChannel,
     return;
   }
 
-  // offset the channel for a 0-based arrays
-  signed char channel = noteChannel - 1;
-
-  if (mapping[noteNum][channel].hasTouch()) {
-    mapping[noteNum][channel].setColRow(col, row);
+  short index = findEntry(noteNum, noteChannel);
+  if (index >= 0) {
+    entries[index].setColRow(col, row);
   }
 }
 
@@ -360,7 +426,12 @@ void NoteTouchMapping::debugNoteChain() {
     signed char entryNote = firstNote;
     signed char entryChannel = firstChannel;
     while (entryNote != -1) {
-      NoteEntry& entry = mapping[entryNote][entryChannel-1];
+      NoteEntry* entryPtr = getNoteEntry(entryNote, entryChannel);
+      if (entryPtr == NULL) {
+        DEBUGPRINT((1," MISSING ENTRY\n"));
+        break;
+      }
+      NoteEntry& entry = *entryPtr;
 
       DEBUGPRINT((1," note="));DEBUGPRINT((1,entryNote));
       DEBUGPRINT((1," channel="));DEBUGPRINT((1,entryChannel));
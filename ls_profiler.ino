@@ -0,0 +1,202 @@
+/************************** ls_profiler: LinnStrument CPU cycle profiler ****************************
+Copyright 2023 Roger Linn Design (https://www.rogerlinndesign.com)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+***************************************************************************************************
+These functions count the CPU cycles that are spent in the touch handling, the sensor reads, the
+MIDI input parsing and the continuous tasks, using the cycle counter of the Cortex-M3 debug unit. For each section, the number
+of calls, the minimum, average and maximum cycles and an estimate of the 99th percentile are kept.
+The profile is displayed in the serial monitor with a secret switch, or read as a block of NRPNs.
+**************************************************************************************************/
+
+#define PROFILE_CYCLES_PER_USEC (VARIANT_MCK / 1000000)
+
+void resetProfile() {
+  for (byte s = 0; s < PROFILE_SECTIONS; ++s) {
+    profileStatistics[s].calls = 0;
+    profileStatistics[s].minCycles = 0xFFFFFFFF;
+    profileStatistics[s].maxCycles = 0;
+    profileStatistics[s].totalCycles = 0;
+    for (byte b = 0; b < PROFILE_BUCKETS; ++b) {
+      profileStatistics[s].histogram[b] = 0;
+    }
+  }
+}
+
+void setProfilerActive(boolean active) {
+  if (active && !profilerActive) {
+    // enable the trace unit and start its cycle counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    resetProfile();
+  }
+  profilerActive = active;
+}
+
+inline unsigned long beginProfile() {
+  if (!profilerActive) {
+    return 0;
+  }
+  return DWT->CYCCNT;
+}
+
+inline void endProfile(byte section, unsigned long start) {
+  if (profilerActive) {
+    recordProfile(section, DWT->CYCCNT - start);
+  }
+}
+
+void recordProfile(byte section, unsigned long cycles) {
+  ProfileStatistics& stats = profileStatistics[section];
+  stats.calls++;
+  stats.totalCycles += cycles;
+  if (cycles < stats.minCycles) stats.minCycles = cycles;
+  if (cycles > stats.maxCycles) stats.maxCycles = cycles;
+
+  byte bucket = (cycles == 0 ? 0 : 32 - __builtin_clz(cycles));
+  if (bucket >= PROFILE_BUCKETS) {
+    bucket = PROFILE_BUCKETS - 1;
+  }
+
+  // halve all the buckets when one is about to saturate, this keeps their proportions for the percentile estimate
+  if (stats.histogram[bucket] == 0xFFFF) {
+    for (byte b = 0; b < PROFILE_BUCKETS; ++b) {
+      stats.histogram[b] >>= 1;
+    }
+  }
+  stats.histogram[bucket]++;
+}
+
+// getProfilePercentileCycles:
+// Estimates the number of cycles below which the percentage of calls of a section stays, as the upper bound
+// of the histogram bucket that reaches that percentage
+unsigned long getProfilePercentileCycles(byte section, byte percent) {
+  ProfileStatistics& stats = profileStatistics[section];
+  unsigned long total = 0;
+  for (byte b = 0; b < PROFILE_BUCKETS; ++b) {
+    total += stats.histogram[b];
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  unsigned long threshold = (total * percent + 99) / 100;
+  unsigned long count = 0;
+  for (byte b = 0; b < PROFILE_BUCKETS; ++b) {
+    count += stats.histogram[b];
+    if (count >= threshold) {
+      // the last bucket has no upper bound
+      if (b == PROFILE_BUCKETS - 1) {
+        break;
+      }
+      return min((1UL << b) - 1, stats.maxCycles);
+    }
+  }
+  return stats.maxCycles;
+}
+
+unsigned long getProfileAverageCycles(byte section) {
+  ProfileStatistics& stats = profileStatistics[section];
+  if (stats.calls == 0) {
+    return 0;
+  }
+  return (unsigned long)(stats.totalCycles / stats.calls);
+}
+
+const char* getProfileSectionName(byte section) {
+  switch (section) {
+    case profileNewTouch: return "newTouch";
+    case profileXYZupdate: return "XYZupdate";
+    case profileTouchRelease: return "touchRelease";
+    case profileReadX: return "readX";
+    case profileReadY: return "readY";
+    case profileReadZ: return "readZ";
+    case profileTasks + taskUpdateClock: return "taskClock";
+    case profileTasks + taskMidiOutput: return "taskMidiOut";
+    case profileTasks + taskMidiInput: return "taskMidiIn";
+    case profileTasks + taskRefreshLeds: return "taskLeds";
+    case profileTasks + taskFootSwitches: return "taskFootSwitches";
+    case profileTasks + taskTouchAnimations: return "taskTouchAnim";
+    case profileTasks + taskStopBlinkingLeds: return "taskBlinking";
+    case profileTasks + taskLegendDisplayTimeout: return "taskLegend";
+    case profileTasks + taskGlobalSettingsDisplay: return "taskGlobalDisplay";
+    case profileTasks + taskSleep: return "taskSleep";
+    case profileMidiInputByte: return "midiInByte";
+  }
+  return "";
+}
+
+// displayProfile:
+// For debug, displays the profile of each section in the Arduino serial monitor every second, in micros
+void displayProfile() {
+  static unsigned long lastReport = 0;
+
+  setProfilerActive(true);
+
+  unsigned long now = micros();
+  if (Device.serialMode && calcTimeDelta(now, lastReport) >= 1000000) {
+    lastReport = now;
+
+    Serial.println("section calls min avg max p99 (us)");
+    for (byte s = 0; s < PROFILE_SECTIONS; ++s) {
+      ProfileStatistics& stats = profileStatistics[s];
+      if (stats.calls == 0) {
+        continue;
+      }
+      Serial.print(getProfileSectionName(s));
+      Serial.print(" ");
+      Serial.print(stats.calls);
+      Serial.print(" ");
+      Serial.print((float)stats.minCycles / PROFILE_CYCLES_PER_USEC);
+      Serial.print(" ");
+      Serial.print((float)getProfileAverageCycles(s) / PROFILE_CYCLES_PER_USEC);
+      Serial.print(" ");
+      Serial.print((float)stats.maxCycles / PROFILE_CYCLES_PER_USEC);
+      Serial.print(" ");
+      Serial.println((float)getProfilePercentileCycles(s, 99) / PROFILE_CYCLES_PER_USEC);
+    }
+    resetProfile();
+  }
+}
+
+// getProfileNrpnValue:
+// The NRPN block has five values for each section: the number of calls and the minimum, average, maximum and
+// 99th percentile in micros, all limited to 14 bits
+int getProfileNrpnValue(int offset) {
+  byte section = offset / PROFILE_NRPN_FIELDS;
+  if (section >= PROFILE_SECTIONS) {
+    return INT_MIN;
+  }
+
+  ProfileStatistics& stats = profileStatistics[section];
+  unsigned long value = 0;
+  switch (offset % PROFILE_NRPN_FIELDS) {
+    case 0:
+      value = stats.calls;
+      break;
+    case 1:
+      value = (stats.calls == 0 ? 0 : stats.minCycles / PROFILE_CYCLES_PER_USEC);
+      break;
+    case 2:
+      value = getProfileAverageCycles(section) / PROFILE_CYCLES_PER_USEC;
+      break;
+    case 3:
+      value = stats.maxCycles / PROFILE_CYCLES_PER_USEC;
+      break;
+    case 4:
+      value = getProfilePercentileCycles(section, 99) / PROFILE_CYCLES_PER_USEC;
+      break;
+  }
+  return min(value, (unsigned long)16383);
+}
@@ -17,6 +17,8 @@ These functions comprise a simple Real Time OS for LinnStrument.
 It consists of a delay function, delayUsec, that updates LinnStrument's LEDs and scans its foot
 switches at specific time interals, all in the background. This should be used instead of
 Arduino's delayMicroseconds() function.
+The background tasks are dispatched from a table by priority, period and deadline, both from
+delayUsec and from the main loop.
 **************************************************************************************************/
 
 
@@ -70,80 +72,39 @@ inline void performContinuousTasks() {
   performContinuousTasks(micros());
 }
 
-inline void performContinuousTasks(unsigned long nowMicros) {
-  if (!setupDone || displayMode == displaySleep) {
-    return;
-  }
-
-  static boolean continuousSerialIO = false;
-
-  boolean ledsRefreshed = false;
-  static boolean continuousRefreshLeds = false;
-  if (!continuousRefreshLeds && !continuousSerialIO) {
-    continuousRefreshLeds = true;
-    ledsRefreshed = checkRefreshLedColumn(nowMicros);
-    continuousRefreshLeds = false;
-  }
-  
-  if (ledsRefreshed) {
-    unsigned long nowMillis = millis();
-
-    static boolean continuousStopBlinkingLeds = false;
-    if (!continuousStopBlinkingLeds) {
-      continuousStopBlinkingLeds = true;
-      checkStopBlinkingLeds(nowMillis);
-      continuousStopBlinkingLeds = false;
-    }
-    
-    static boolean continuousAdvanceTouchAnimations = false;
-    if (!continuousAdvanceTouchAnimations) {
-      continuousAdvanceTouchAnimations = true;
-      checkTimeToRefreshTouchAnim(nowMillis);
-      continuousAdvanceTouchAnimations = false;
-    }
-
-    static boolean continuousLegendDisplayTimeout = false;
-    if (!continuousLegendDisplayTimeout) {
-      continuousLegendDisplayTimeout = true;
-      checkLegendDisplayTimeout(nowMillis);
-      continuousLegendDisplayTimeout = false;
-    }
+volatile boolean continuousSerialIO = false;     // also checked by the LED refresh timer interrupt
 
-    static boolean continuousFootSwitches = false;
-    if (!continuousFootSwitches) {
-      continuousFootSwitches = true;
-      checkTimeToReadFootSwitches(nowMicros);
-      continuousFootSwitches = false;
-    }
-
-    static boolean continuousRefreshGlobalSettingsDisplay = false;
-    if (!continuousRefreshGlobalSettingsDisplay) {
-      continuousRefreshGlobalSettingsDisplay = true;
-      checkRefreshGlobalSettingsDisplay(nowMicros);
-      continuousRefreshGlobalSettingsDisplay = false;
-    }
-
-    static boolean continuousSleep = false;
-    if (!continuousSleep) {
-      continuousSleep = true;
-      checkSleep(nowMillis);
-      continuousSleep = false;
-    }
+void resetContinuousTaskStatistics() {
+  for (byte t = 0; t < CONTINUOUS_TASK_COUNT; ++t) {
+    continuousTasks[t].deadlineOverruns = 0;
+    continuousTasks[t].budgetOverruns = 0;
   }
+}
 
-  static boolean continuousUpdateClock = false;
-  boolean clockUpdated = false;
-  if (!continuousUpdateClock) {
-    continuousUpdateClock = true;
-    clockUpdated = checkUpdateClock(nowMicros);
-    continuousUpdateClock = false;
+// getContinuousTaskBudget:
+// Returns the budget of a task in micros, the MIDI input task follows the adjustable MIDI input budget and the others
+// come from the table
+inline unsigned long getContinuousTaskBudget(byte t) {
+  if (t == taskMidiInput) {
+    return Device.midiInputBudget + MIDI_INPUT_TASK_MARGIN;
   }
+  return continuousTasks[t].budget;
+}
 
-  if (clockUpdated) {
+void performUpdateClockTask(unsigned long nowMicros) {
+  if (checkUpdateClock(nowMicros)) {
     performCheckAdvanceArpeggiator();
     performCheckAdvanceSequencer();
   }
+}
 
+void performMidiOutputTask(unsigned long nowMicros) {
+  if (!Device.serialMode) {
+    handlePendingMidi(nowMicros);
+  }
+}
+
+void performMidiInputTask(unsigned long nowMicros) {
   if (Device.serialMode) {
     if (!continuousSerialIO) {
       continuousSerialIO = true;
@@ -152,26 +113,119 @@ inline void performContinuousTasks(unsigned long nowMicros) {
     }
   }
   else {
-    static boolean continuousMidiInput = false;
-    if (!continuousMidiInput) {
-      continuousMidiInput = true;
-      handleMidiInput(nowMicros);
-      continuousMidiInput = false;
+    handleMidiInput(nowMicros);
+  }
+}
+
+void performRefreshLedsTask(unsigned long nowMicros) {
+  if (!continuousSerialIO) {
+    checkRefreshLedColumn(nowMicros);
+  }
+}
+
+// performContinuousTask:
+// Runs a single task of the continuous tasks table
+void performContinuousTask(byte task, unsigned long nowMicros) {
+  switch (task) {
+    case taskUpdateClock:
+      performUpdateClockTask(nowMicros);
+      break;
+    case taskMidiOutput:
+      performMidiOutputTask(nowMicros);
+      break;
+    case taskMidiInput:
+      performMidiInputTask(nowMicros);
+      break;
+    case taskRefreshLeds:
+      performRefreshLedsTask(nowMicros);
+      break;
+    case taskFootSwitches:
+      checkTimeToReadFootSwitches(nowMicros);
+      break;
+    case taskTouchAnimations:
+      checkTimeToRefreshTouchAnim(millis());
+      break;
+    case taskStopBlinkingLeds:
+      checkStopBlinkingLeds(millis());
+      break;
+    case taskLegendDisplayTimeout:
+      checkLegendDisplayTimeout(millis());
+      break;
+    case taskGlobalSettingsDisplay:
+      checkRefreshGlobalSettingsDisplay(nowMicros);
+      break;
+    case taskSleep:
+      checkSleep(millis());
+      break;
+  }
+}
+
+inline void performContinuousTasks(unsigned long nowMicros) {
+  if (!setupDone || displayMode == displaySleep) {
+    return;
+  }
+
+  // MIDI messages that are queued by the continuous tasks are not caused by the touch that's being handled
+  unsigned long latencyOrigin = midiLatencyOrigin;
+  midiLatencyOrigin = 0;
+
+  unsigned long dispatchStart = nowMicros;
+  for (byte t = 0; t < CONTINUOUS_TASK_COUNT; ++t) {
+    ContinuousTask& task = continuousTasks[t];
+    if (task.running) {
+      continue;
     }
 
-    static boolean continuousPendingMidi = false;
-    if (!continuousPendingMidi) {
-      continuousPendingMidi = true;
-      handlePendingMidi(nowMicros);
-      continuousPendingMidi = false;
+    // the LEDs aren't refreshed during serial IO, the tasks that follow the LED refresh in the table wait for it to finish
+    if (continuousSerialIO && t > taskRefreshLeds) {
+      continue;
     }
+
+    unsigned long sinceLastRun = calcTimeDelta(nowMicros, task.lastRun);
+    if (sinceLastRun < task.period) {
+      continue;
+    }
+
+    // once the dispatch is over budget, only the tasks that are past their deadline still run
+    boolean late = (sinceLastRun - task.period > task.deadline);
+    if (!late && calcTimeDelta(nowMicros, dispatchStart) > CONTINUOUS_TASKS_BUDGET) {
+      continue;
+    }
+    if (late && task.lastRun != 0) {
+      task.deadlineOverruns++;
+    }
+
+    task.running = true;
+    task.lastRun = nowMicros;
+    unsigned long profileStart = beginProfile();
+    performContinuousTask(t, nowMicros);
+    endProfile(profileTasks + t, profileStart);
+    task.running = false;
+
+    unsigned long finished = micros();
+    if (calcTimeDelta(finished, nowMicros) > getContinuousTaskBudget(t)) {
+      task.budgetOverruns++;
+    }
+    nowMicros = finished;
   }
+
+  midiLatencyOrigin = latencyOrigin;
 }
 
 // checks to see if it's time to refresh the next LED column, and if so, does it
-// the return value indicate whether the LEDs were updated, so that we can use it
-// as a coarse trigger to piggy-back other continuous tasks off of
+// the return value indicate whether the LEDs were updated
 inline boolean checkRefreshLedColumn(unsigned long now) {
+  // when the timer interrupt is refreshing the LEDs, only report whether it did so since the last check
+  if (ledRefreshTimerActive) {
+    static byte lastLedRefreshCount = 0;
+    byte count = ledRefreshCount;
+    if (count != lastLedRefreshCount) {
+      lastLedRefreshCount = count;
+      return true;
+    }
+    return false;
+  }
+
   if (calcTimeDelta(now, prevLedTimerCount) > ledRefreshInterval) {        // is it time to refresh the next LED column?
     refreshLedColumn(now);                                                 // yes, refresh the next LED column...
     prevLedTimerCount = now;                                               // and reset the LED timer count to current time
@@ -180,6 +234,79 @@ inline boolean checkRefreshLedColumn(unsigned long now) {
   return false;
 }
 
+// The LED columns are refreshed from a hardware timer interrupt, this makes the LED brightness and pulse
+// timing independent of the load of the sensor scan. The LEDs share the SPI bus with the touch sensor
+// and the ADC though, so when the interrupt fires during a sensor transfer, the LED refresh is deferred
+// until that transfer is done.
+#define LED_TIMER                 TC1
+#define LED_TIMER_CHANNEL         0
+#define LED_TIMER_ID              ID_TC3
+#define LED_TIMER_IRQ             TC3_IRQn
+#define LED_TIMER_TICKS_PER_USEC  (VARIANT_MCK / 2 / 1000000)               // TIMER_CLOCK1 runs at MCK/2
+
+void initializeLedRefreshTimer() {
+  pmc_set_writeprotect(false);
+  pmc_enable_periph_clk(LED_TIMER_ID);
+  TC_Configure(LED_TIMER, LED_TIMER_CHANNEL, TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC | TC_CMR_TCCLKS_TIMER_CLOCK1);
+  TC_SetRC(LED_TIMER, LED_TIMER_CHANNEL, ledRefreshInterval * LED_TIMER_TICKS_PER_USEC);
+  LED_TIMER->TC_CHANNEL[LED_TIMER_CHANNEL].TC_IER = TC_IER_CPCS;
+  LED_TIMER->TC_CHANNEL[LED_TIMER_CHANNEL].TC_IDR = ~TC_IER_CPCS;
+  NVIC_EnableIRQ(LED_TIMER_IRQ);
+  TC_Start(LED_TIMER, LED_TIMER_CHANNEL);
+  ledRefreshTimerActive = true;
+}
+
+inline void performTimedLedRefresh(unsigned long now) {
+  refreshLedColumn(now);
+  prevLedTimerCount = now;
+  ledRefreshCount++;
+}
+
+void TC3_Handler() {
+  TC_GetStatus(LED_TIMER, LED_TIMER_CHANNEL);                               // acknowledge the interrupt
+
+  // the refresh interval can change at any time, it's picked up for the next period
+  TC_SetRC(LED_TIMER, LED_TIMER_CHANNEL, ledRefreshInterval * LED_TIMER_TICKS_PER_USEC);
+
+  if (!setupDone || displayMode == displaySleep || continuousSerialIO) {
+    return;
+  }
+
+  if (spiBusy) {
+    ledRefreshPending = true;
+    return;
+  }
+
+  ledRefreshPending = false;
+  performTimedLedRefresh(micros());
+}
+
+// beginSpiTransfer:
+// Marks the SPI bus as in use for the touch sensor or the ADC, this prevents the LED timer from using it
+inline void beginSpiTransfer() {
+  spiBusy = true;
+}
+
+// endSpiTransfer:
+// Releases the SPI bus and performs any LED refresh that was deferred while it was in use. The bus stays claimed
+// while the deferred refresh runs, so the timer can mark another refresh as pending meanwhile, this is checked
+// again with the interrupts disabled until nothing is pending and the bus can really be released.
+inline void endSpiTransfer() {
+  while (true) {
+    noInterrupts();
+    boolean pending = ledRefreshPending;
+    ledRefreshPending = false;
+    if (!pending) {
+      spiBusy = false;
+      interrupts();
+      return;
+    }
+    interrupts();
+
+    performTimedLedRefresh(micros());
+  }
+}
+
 inline void checkTimeToRefreshTouchAnim(unsigned long now) {
   if (calcTimeDelta(now, prevTouchAnimTimerCount) > 33) {
     performAdvanceTouchAnimations(now);
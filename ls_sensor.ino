@@ -56,6 +56,32 @@ const short Z_BIAS_128_SEPTEMBER2019[MAXROWS][MAXCOLS] =  {
 
 const short Z_BIAS_MULTIPLIER = 1400;
 
+// The analog switches are selected ahead of time whenever the next read is known, this allows their
+// settling time to overlap with other processing instead of waiting for it right before each read.
+byte selectedSensorCol = 0;                           // column that the analog switches are currently set to
+byte selectedSensorRow = 0;                           // row that the analog switches are currently set to
+byte selectedSensorSwitchCode = READ_Z;               // axis that the analog switches are currently set to read
+unsigned long selectedSensorMoment = 0;               // moment in micros that the analog switches were set
+
+// prepareSensorCell:
+// Sets the analog switches for an upcoming read, unless they're already set that way
+inline void prepareSensorCell(byte col, byte row, byte switchCode) {
+  if (col != selectedSensorCol || row != selectedSensorRow || switchCode != selectedSensorSwitchCode) {
+    selectSensorCell(col, row, switchCode);
+  }
+}
+
+// settleSensorCell:
+// Sets the analog switches for a read and waits until they've had at least settleTime microseconds to
+// stabilize, any time that has already passed since they were selected ahead of time is deducted
+inline void settleSensorCell(byte col, byte row, byte switchCode, unsigned long settleTime) {
+  prepareSensorCell(col, row, switchCode);
+  unsigned long elapsed = calcTimeDelta(micros(), selectedSensorMoment);
+  if (elapsed < settleTime) {
+    delayUsec(settleTime - elapsed);
+  }
+}
+
 // readX:
 // Reads raw X value at the currently addressed column and row
 const short READX_FLATZONE = 25;
@@ -95,8 +121,6 @@ inline short readX(byte zPct) {                       // returns the raw X value
 
   DEBUGPRINT((3,"readX\n"));
 
-  selectSensorCell(sensorCol, sensorRow, READ_X);     // set analog switches to this column and row, and to read X
-
   short d;
   if (zPct <= READX_FLATZONE) {
     d = READX_MAX_DELAY;
@@ -105,7 +129,7 @@ inline short readX(byte zPct) {                       // returns the raw X value
     d = READX_MAX_DELAY - (READX_RANGE_DELAY * min(zPct - READX_FLATZONE, READX_RANGE) / READX_RANGE);
   }
 
-  delayUsec(d);                                       // delay required after setting analog switches for stable X read
+  settleSensorCell(sensorCol, sensorRow, READ_X, d);  // set analog switches to this column and row, and to read X with a stable delay
   return spiAnalogRead();
 }
 
@@ -126,8 +150,6 @@ inline short readY(byte zPct) {                       // returns a value of 0-12
 
   DEBUGPRINT((3,"readY\n"));
 
-  selectSensorCell(sensorCol, sensorRow, READ_Y);     // set analog switches to this cell and to read Y
-
   short d;
   if (zPct <= READY_FLATZONE) {
     d = READY_MAX_DELAY;
@@ -136,7 +158,7 @@ inline short readY(byte zPct) {                       // returns a value of 0-12
     d = READY_MAX_DELAY - (READY_RANGE_DELAY * min(zPct - READY_FLATZONE, READY_RANGE) / READY_RANGE);
   }
 
-  delayUsec(d);                                       // delay required after setting analog switches for stable Y read
+  settleSensorCell(sensorCol, sensorRow, READ_Y, d);  // set analog switches to this cell and to read Y with a stable delay
   return spiAnalogRead();
 }
 
@@ -162,12 +184,10 @@ inline unsigned short readZ() {                       // returns the raw Z value
 
   DEBUGPRINT((3,"readZ\n"));
 
-  selectSensorCell(sensorCol, sensorRow, READ_Z);     // set analog switches to current cell in touch sensor and read Z
-
   short rawZ;
 
   if (controlModeActive) {
-    delayUsec(READZ_DELAY_CONTROLMODE);
+    settleSensorCell(sensorCol, sensorRow, READ_Z, READZ_DELAY_CONTROLMODE);
 
     // read raw Z value and invert it from (4095 - 0) to (0-4095)
     rawZ = 4095 - spiAnalogRead();
@@ -175,18 +195,24 @@ inline unsigned short readZ() {                       // returns the raw Z value
   else {
     // if there are active touches in the column, always use a settling time
     if (sensorCol == 0) {
-      delayUsec(READZ_DELAY_SWITCH);
+      settleSensorCell(sensorCol, sensorRow, READ_Z, READZ_DELAY_SWITCH);
     }
     else if (rowsInColsTouched[sensorCol]) {
-      delayUsec(READZ_DELAY_SENSOR);
+      settleSensorCell(sensorCol, sensorRow, READ_Z, READZ_DELAY_SENSOR);
     }
+    else {
+      prepareSensorCell(sensorCol, sensorRow, READ_Z);
+    }
+
+    // when the analog switches were selected ahead of time, they might already have settled
+    boolean settled = calcTimeDelta(micros(), selectedSensorMoment) >= READZ_DELAY_SENSORINITIAL;
 
     // read raw Z value and invert it from (4095 - 0) to (0-4095)
     rawZ = 4095 - spiAnalogRead();
 
     // if there are no active touches in the column, but the raw pressure without settling time exceeds the value threshold,
     // introduce a settling time to read the proper stabilized value
-    if (rowsInColsTouched[sensorCol] == 0 && rawZ > READZ_SETTLING_PRESSURE_THRESHOLD) {
+    if (!settled && rowsInColsTouched[sensorCol] == 0 && rawZ > READZ_SETTLING_PRESSURE_THRESHOLD) {
         delayUsec(READZ_DELAY_SENSORINITIAL);
         rawZ = 4095 - spiAnalogRead();
     }
@@ -206,8 +232,10 @@ inline unsigned short readZ() {                       // returns the raw Z value
 // spiAnalogRead:
 // returns raw ADC output at current cell
 inline short spiAnalogRead() {
+  beginSpiTransfer();
   byte msb = SPI.transfer(SPI_ADC, 0, SPI_CONTINUE);         // read byte MSB
   byte lsb = SPI.transfer(SPI_ADC, 0);                       // read byte LSB
+  endSpiTransfer();
 
   // assemble the 2 transfered bytes into an int
   short raw = short(msb) << 8;
@@ -277,6 +305,14 @@ inline void selectSensorCell(byte col, byte row, byte switchCode) {
     break;
   }
 
+  beginSpiTransfer();
   SPI.transfer(SPI_SENSOR, lsb, SPI_CONTINUE);    // to daisy-chained 595 (LSB)
   SPI.transfer(SPI_SENSOR, msb);                  // to first 595 at MOSI (MSB, for both sensor columns and LED columns)
+  endSpiTransfer();
+
+  // remember the selection so that the settling time can be tracked
+  selectedSensorCol = col;
+  selectedSensorRow = row;
+  selectedSensorSwitchCode = switchCode;
+  selectedSensorMoment = micros();
 }
@@ -36,7 +36,8 @@ enum linnCommands {
   SendProjects = 'p',
   RestoreProject = 'q',
   RestoreSettings = 'r',
-  SendSettings = 's'
+  SendSettings = 's',
+  SendLatencyHistograms = 'h'
 };
 
 byte codePos = 0;
@@ -115,6 +116,12 @@ void handleSerialIO() {
         break;
       }
 
+      case SendLatencyHistograms:
+      {
+        serialSendLatencyHistograms();
+        break;
+      }
+
       default:
       {
         waitingForCommands = false;
@@ -342,6 +349,20 @@ void serialLightLed() {
   updateDisplay();
 }
 
+void serialSendLatencyHistograms() {
+  Serial.write(ackCode);
+
+  int32_t histogramSize = sizeof(midiLatencyHistogram);
+
+  // send the size of the histograms
+  Serial.write((byte*)&histogramSize, sizeof(int32_t));
+
+  // send the actual histograms, one row of buckets for each MIDI message type
+  Serial.write((byte*)midiLatencyHistogram, histogramSize);
+
+  Serial.write(ackCode);
+}
+
 int32_t serialSendProjectSize() {
   // send the size of a project
   int32_t projectSize = sizeof(SequencerProject);
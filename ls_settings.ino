@@ -309,6 +309,7 @@ void applyPresetSettings() {
   applyLimitsForY();
   applyLimitsForZ();
   applyLimitsForVelocity();
+  applySensorRangesZ();
 
   applyMidiIo();
 
@@ -317,6 +318,7 @@ void applyPresetSettings() {
 }
 
 void applyConfiguration() {
+  precomputeCalibrationData();
   applyPresetSettings();
   applySequencerSettings();
   loadCustomLedLayer(getActiveCustomLedPattern());
@@ -346,7 +348,7 @@ void storeSettingsToPreset(byte p) {
 // The first time after new code is loaded into the Linnstrument, this sets the initial defaults of all settings.
 // On subsequent startups, these values are overwritten by loading the settings stored in flash.
 void initializeDeviceSettings() {
-  Device.version = 17;
+  Device.version = 18;
   Device.serialMode = false;
   Device.sleepAnimationActive = false;
   Device.sleepActive = false;
@@ -357,6 +359,11 @@ void initializeDeviceSettings() {
   Device.splitHandedness = reversedBoth;
   Device.minUSBMIDIInterval = DEFAULT_MIN_USB_MIDI_INTERVAL;
   Device.midiThrough = false;
+  Device.midiRunningStatus = DEFAULT_MIDI_RUNNING_STATUS;
+  Device.midiRetriggerUSB = DEFAULT_MIDI_RETRIGGER;
+  Device.midiRetriggerDIN = DEFAULT_MIDI_RETRIGGER;
+  Device.midiBatchedWrites = DEFAULT_MIDI_BATCHED_WRITES;
+  Device.midiInputBudget = DEFAULT_MIDI_INPUT_BUDGET;
   Device.lastLoadedPreset = -1;
   Device.lastLoadedProject = -1;
   Global.splitActive = false;
@@ -568,6 +575,7 @@ void initializePresetSettings() {
     g.minForVelocity = DEFAULT_MIN_VELOCITY;
     g.maxForVelocity = DEFAULT_MAX_VELOCITY;
     g.valueForFixedVelocity = DEFAULT_FIXED_VELOCITY;
+    g.velocityOnset = DEFAULT_VELOCITY_ONSET;
     g.pressureSensitivity = pressureMedium;
     g.pressureAftertouch = false;
     g.midiIO = 1;      // set to 1 for USB jacks (not MIDI jacks)
@@ -713,6 +721,7 @@ void initializePresetSettings() {
   applyLimitsForY();
   applyLimitsForZ();
   applyLimitsForVelocity();
+  applySensorRangesZ();
   for (byte s = 0; s < NUMSPLITS; ++s) {
     for (byte c = 0; c < 129; ++c) {
       ccFaderValues[s][c] = 0;
@@ -2074,14 +2083,17 @@ void handleCustomSwitchAssignmentConfigRelease() {
 
 void handleLimitsForVelocityNewTouch() {
   switch (limitsForVelocityConfigState) {
-    case 1:
+    case 2:
       handleNumericDataNewTouchCol(Global.minForVelocity, 1, 127, false);
       break;
-    case 0:
+    case 1:
       handleNumericDataNewTouchCol(Global.maxForVelocity, 1, 127, false);
       break;
+    case 0:
+      handleNumericDataNewTouchCol(Global.velocityOnset, velocityOnsetRegular, velocityOnsetEarlyCorrected, true);
+      break;
   }
-  handleNumericDataNewTouchRow(limitsForVelocityConfigState, 0, 1);
+  handleNumericDataNewTouchRow(limitsForVelocityConfigState, 0, 2);
 }
 
 void handleLimitsForVelocityRelease() {
@@ -2228,6 +2240,7 @@ void handleSensorFeatherZRelease() {
 
 void handleSensorRangeZNewTouch() {
   handleNumericDataNewTouchCol(Device.sensorRangeZ, 3 * 127, MAX_SENSOR_RANGE_Z - 127, false);
+  applySensorRangesZ();
 }
 
 void handleSensorRangeZRelease() {
@@ -2478,6 +2491,7 @@ void handleGlobalSettingNewTouch() {
         case velocityHigh:
         case velocityFixed:
           Global.velocitySensitivity = VelocitySensitivity(sensorRow);
+          applySensorRangesZ();
           break;
       }
       break;
@@ -2489,9 +2503,11 @@ void handleGlobalSettingNewTouch() {
         case pressureLow:
         case pressureHigh:
           Global.pressureSensitivity = PressureSensitivity(sensorRow);
+          applySensorRangesZ();
           break;
         case pressureMedium:
           Global.pressureSensitivity = PressureSensitivity(sensorRow);
+          applySensorRangesZ();
           if (isCalibrationCellHeld()) {
             resetNumericDataChange();
             setDisplayMode(displaySensorSensitivityZ);
@@ -2500,6 +2516,7 @@ void handleGlobalSettingNewTouch() {
           break;
         case 3:
           Global.pressureAftertouch = !Global.pressureAftertouch;
+          applySensorRangesZ();
       }
       break;
 
@@ -151,20 +151,86 @@ void displayZFrame() {
   }
 }
 
-// For debug, displays an entire frame of raw Z values in the Arduino serial monitor. Values are collected during each full read of the touch surface.
-void displaySurfaceScanTime() { 
-  if (sensorCol == 1 && sensorRow == 0) {
+// displaySurfaceScanTime:
+// For debug, displays the average time of a total surface scan in the Arduino serial monitor, together with
+// the revisit intervals that the adaptive scan achieved for idle cells and for touched cells.
+void displaySurfaceScanTime() {
+  static unsigned long idleIntervalMax = 0;
+  static unsigned long touchedIntervalMax = 0;
+  static unsigned long touchedIntervalTotal = 0;
+  static unsigned long touchedVisits = 0;
+
+  unsigned long now = micros();
+
+#ifdef DEBUG_ENABLED
+  // the revisit moments of each cell are only kept in debug builds
+  static unsigned long lastVisit[MAXCOLS][MAXROWS];
+
+  // the control switches are only scanned once every eight surface scans, leave them out
+  if (sensorCol > 0 && lastVisit[sensorCol][sensorRow] != 0) {
+    unsigned long interval = calcTimeDelta(now, lastVisit[sensorCol][sensorRow]);
+    if (sensorCell->touched == touchedCell) {
+      touchedIntervalTotal += interval;
+      touchedIntervalMax = max(touchedIntervalMax, interval);
+      touchedVisits++;
+    }
+    else if (sensorCell->touched == untouchedCell) {
+      idleIntervalMax = max(idleIntervalMax, interval);
+    }
+  }
+  lastVisit[sensorCol][sensorRow] = now;
+#endif
+
+  if (!priorityScanVisit && sensorCol == 1 && sensorRow == 0) {
     static int scanCount; 
     static unsigned long scanPeriod; 
     if (++scanCount > 255) { 
       Serial.print("Total surface scan time in microseconds: ");
-      Serial.println((micros() - scanPeriod) / 256); 
-      scanPeriod = micros(); 
-      scanCount = 0;   
+      Serial.println((now - scanPeriod) / 256);
+      Serial.print("Idle cell maximum revisit interval: ");
+      Serial.println(idleIntervalMax);
+      if (touchedVisits > 0) {
+        Serial.print("Touched cell average revisit interval: ");
+        Serial.print(touchedIntervalTotal / touchedVisits);
+        Serial.print(", maximum: ");
+        Serial.print(touchedIntervalMax);
+        Serial.print(", touched cell visits per surface scan: ");
+        Serial.println(touchedVisits / 256);
+      }
+      scanPeriod = now; 
+      scanCount = 0;
+      idleIntervalMax = 0;
+      touchedIntervalMax = 0;
+      touchedIntervalTotal = 0;
+      touchedVisits = 0;
     }
   }
 }
 
+// displayScanFrequency:
+// For debug, displays the number of total surface scans and of cell reads that were achieved each second.
+void displayScanFrequency() {
+  static unsigned long lastReport = 0;
+  static unsigned long surfaceScans = 0;
+  static unsigned long cellReads = 0;
+
+  cellReads++;
+  if (!priorityScanVisit && sensorCol == 1 && sensorRow == 0) {
+    surfaceScans++;
+  }
+
+  unsigned long now = micros();
+  if (calcTimeDelta(now, lastReport) >= 1000000) {
+    Serial.print("Surface scans per second: ");
+    Serial.print(surfaceScans);
+    Serial.print(", cell reads per second: ");
+    Serial.println(cellReads);
+    lastReport = now;
+    surfaceScans = 0;
+    cellReads = 0;
+  }
+}
+
 // displayCellTouchedFrame:
 // For debug, displays an entire frame of raw Z values in the Arduino serial monitor. Values are collected during each full read of the touch surface.
 void displayCellTouchedFrame() {
@@ -183,6 +249,37 @@ void displayCellTouchedFrame() {
   }
 }
 
+// captureTouchSample:
+// For debug, streams the raw samples of the touch surface to the Arduino serial monitor so that gestures can be
+// recorded and replayed later through the touch handling. Each surface scan starts with a line 'F <micros>', followed
+// by a line 'S <col> <row> <previous state> <state> <raw X> <raw Y> <raw Z>' for each cell that has pressure or that
+// is or was touched. The states are the numeric TouchState values before and after the cell was handled.
+void captureTouchSample(TouchState previousTouch) {
+  if (!priorityScanVisit && sensorCol == 1 && sensorRow == 0) {
+    Serial.print("F ");
+    Serial.println(micros());
+  }
+
+  if (previousTouch == untouchedCell && sensorCell->touched == untouchedCell && sensorCell->currentRawZ == 0) {
+    return;
+  }
+
+  Serial.print("S ");
+  Serial.print(sensorCol);
+  Serial.print(" ");
+  Serial.print(sensorRow);
+  Serial.print(" ");
+  Serial.print(previousTouch);
+  Serial.print(" ");
+  Serial.print(sensorCell->touched);
+  Serial.print(" ");
+  Serial.print(sensorCell->currentRawX);
+  Serial.print(" ");
+  Serial.print(sensorCell->currentRawY);
+  Serial.print(" ");
+  Serial.println(sensorCell->currentRawZ);
+}
+
 void modeLoopManufacturingTest() {
   TouchState previousTouch = sensorCell->touched;
   sensorCell->refreshZ();
@@ -266,7 +363,7 @@ void modeLoopManufacturingTest() {
   unsigned long now = micros();
   
   // send out MIDI activity
-  midiOutQueue.push((byte)MIDIActiveSensing);
+  queueMidiMessage(MIDIActiveSensing, 0, 0, 0);
   handlePendingMidi(now);
   handleMidiInput(now);
 
@@ -226,6 +226,11 @@ void initializeTouchInfo() {
 // This element of the linear regression algorithm is constant based on the number of velocity samples 
 const int VELOCITY_SXX = (VELOCITY_N * VELOCITY_SUMXSQ) - VELOCITY_SUMX * VELOCITY_SUMX;
 
+// For early velocity onset, the regressions are also calculated with fewer samples, these are
+// the sums of the X values and the constant regression elements for each number of samples
+const int VELOCITY_PARTIAL_SUMX[VELOCITY_SAMPLES+1] = {0, 1, 3, 6, VELOCITY_SUMX};
+const int VELOCITY_PARTIAL_SXX[VELOCITY_SAMPLES+1] = {1, 1, 6, 20, VELOCITY_SXX};
+
 inline byte scale1016to127(int v, boolean allowZero) {
   // reduce 1016 > 127 by dividing, but we do this so that values are rounded instead of truncated
   // we also assume that all values that are equal to zero are filtered out already, so the bottom
@@ -241,6 +246,8 @@ static unsigned short velSumXY1;
 static byte vcount2;
 static unsigned short velSumY2;
 static unsigned short velSumXY2;
+static byte earlyVelocity;
+static unsigned long earlyVelocityMoment;
 
 // Re-initialize the velocity detection
 void initVelocity() {
@@ -252,10 +259,57 @@ void initVelocity() {
   velSumY2 = 0;
   velSumXY2 = 0;
 
+  earlyVelocity = 0;
+
   sensorCell->vcount = 0;
   sensorCell->velocity = 0;
 }
 
+// Calculate the raw slope of one of the velocity regressions, based on the number of samples that it contains
+inline int calcVelocitySlope(int scale, byte samples, unsigned short sumY, unsigned short sumXY) {
+  int sxy = ((samples + VELOCITY_ZERO_POINTS) * sumXY) - VELOCITY_PARTIAL_SUMX[samples] * sumY;
+  return constrain((scale * sxy) / VELOCITY_PARTIAL_SXX[samples], 1, 1016);
+}
+
+byte calcVelocityFromRegressions() {
+  int scale;
+  const short* curve;
+  switch (Global.velocitySensitivity) {
+    case velocityHigh:
+      scale = VELOCITY_SCALE_HIGH;
+      curve = Z_CURVE_HIGH;
+      break;
+    case velocityMedium:
+    default:
+      scale = VELOCITY_SCALE_MEDIUM;
+      curve = Z_CURVE_MEDIUM;
+      break;
+    case velocityLow:
+      scale = VELOCITY_SCALE_LOW;
+      curve = Z_CURVE_LOW;
+      break;
+  }
+
+  int rawSlope1 = calcVelocitySlope(scale, vcount1, velSumY1, velSumXY1);
+  int rawSlope2 = calcVelocitySlope(scale, vcount2, velSumY2, velSumXY2);
+
+  // with early velocity onset, both interleaved regressions have to agree before the velocity is considered reliable,
+  // a fixed velocity doesn't depend on the slopes and can always be sent as early as possible
+  if (sensorCell->vcount < VELOCITY_TOTAL_SAMPLES && Global.velocitySensitivity != velocityFixed &&
+      abs(rawSlope1 - rawSlope2) > VELOCITY_EARLY_BOUND) {
+    return 0;
+  }
+
+  int slope1 = curve[rawSlope1];
+  int slope2 = curve[rawSlope2];
+
+  int slope = FXD_TO_INT(fxdMinVelOffset + FXD_MUL(FXD_DIV(FXD_FROM_INT(slope1 + slope2), FXD_CONST_2), fxdVelRatio));
+
+  slope = scale1016to127(slope, false);
+
+  return calcPreferredVelocity(slope);
+}
+
 VelocityState calcVelocity(unsigned short z) {
   if (sensorCell->vcount < VELOCITY_TOTAL_SAMPLES) {
 
@@ -275,44 +329,69 @@ VelocityState calcVelocity(unsigned short z) {
 
     // when the number of samples are reached, calculate the final velocity
     if (sensorCell->vcount == VELOCITY_TOTAL_SAMPLES) {
-      int scale;
-      const short* curve;
-      switch (Global.velocitySensitivity) {
-        case velocityHigh:
-          scale = VELOCITY_SCALE_HIGH;
-          curve = Z_CURVE_HIGH;
-          break;
-        case velocityMedium:
-        default:
-          scale = VELOCITY_SCALE_MEDIUM;
-          curve = Z_CURVE_MEDIUM;
-          break;
-        case velocityLow:
-          scale = VELOCITY_SCALE_LOW;
-          curve = Z_CURVE_LOW;
-          break;
-      }
-      int sxy1 = (VELOCITY_N * velSumXY1) - VELOCITY_SUMX * velSumY1;
-      int slope1 = curve[constrain((scale * sxy1) / VELOCITY_SXX, 1, 1016)];
-      int sxy2 = (VELOCITY_N * velSumXY2) - VELOCITY_SUMX * velSumY2;
-      int slope2 = curve[constrain((scale * sxy2) / VELOCITY_SXX, 1, 1016)];
+      byte velocity = calcVelocityFromRegressions();
+
+      // if the note was already sent with an early velocity, report the correction instead
+      if (earlyVelocity) {
+        DEBUGPRINT((1,"calcVelocity"));
+        DEBUGPRINT((1," early="));DEBUGPRINT((1,(int)earlyVelocity));
+        DEBUGPRINT((1," final="));DEBUGPRINT((1,(int)velocity));
+        DEBUGPRINT((1,"\n"));
 
-      int slope = FXD_TO_INT(fxdMinVelOffset + FXD_MUL(FXD_DIV(FXD_FROM_INT(slope1 + slope2), FXD_CONST_2), fxdVelRatio));
+        recordVelocityOnset(earlyVelocity, velocity);
 
-      slope = scale1016to127(slope, false);
+        sensorCell->velocity = velocity;
+        return velocity != earlyVelocity ? velocityCorrected : velocityCalculated;
+      }
+
+      if (Global.velocityOnset != velocityOnsetRegular && displayMode == displayNormal) {
+        velocityOnsetLateCount++;
+      }
 
-      sensorCell->velocity = calcPreferredVelocity(slope);
+      sensorCell->velocity = velocity;
 
       return velocityNew;
     }
-    else {
-      return velocityCalculating;
+    // with early velocity onset, try to send the velocity as soon as both regressions have enough samples,
+    // the remaining samples are still gathered to be able to compare and correct the velocity
+    else if (Global.velocityOnset != velocityOnsetRegular && displayMode == displayNormal &&
+             !earlyVelocity && sensorCell->vcount % 2 == 0 && vcount2 >= VELOCITY_EARLY_SAMPLES) {
+      earlyVelocity = calcVelocityFromRegressions();
+      if (earlyVelocity) {
+        earlyVelocityMoment = micros();
+        sensorCell->velocity = earlyVelocity;
+        return velocityNew;
+      }
     }
+
+    return velocityCalculating;
   }
 
   return velocityCalculated;
 }
 
+// recordVelocityOnset:
+// Adds the difference between the early and the final velocity of a touch to the histogram, together with the time
+// that the early velocity was sent before the final one could have been
+void recordVelocityOnset(byte early, byte velocity) {
+  byte difference = abs(velocity - early);
+  byte bucket = 0;
+  while (difference > 0 && bucket < VELOCITY_ONSET_BUCKETS - 1) {
+    difference >>= 1;
+    bucket++;
+  }
+  velocityOnsetHistogram[bucket]++;
+
+  unsigned long now = micros();
+  velocityOnsetSavedTotal += calcTimeDelta(now, earlyVelocityMoment);
+}
+
+void resetVelocityOnsetStatistics() {
+  memset(velocityOnsetHistogram, 0, sizeof(velocityOnsetHistogram));
+  velocityOnsetLateCount = 0;
+  velocityOnsetSavedTotal = 0;
+}
+
 byte calcPreferredVelocity(byte velocity) {
   // determine the preferred velocity based on the sensitivity settings
   if (Global.velocitySensitivity == velocityFixed) {
@@ -350,10 +429,18 @@ short TouchInfo::calibratedX() {
 
 inline void TouchInfo::refreshX() {
   if (shouldRefreshX) {
+    unsigned long profileStart = beginProfile();
     currentRawX = readX(percentRawZ);
-    currentCalibratedX = calculateCalibratedX(currentRawX);
+    endProfile(profileReadX, profileStart);
     shouldRefreshX = false;
 
+    // start settling the analog switches for the Y read while X is being processed
+    if (shouldRefreshY) {
+      prepareSensorCell(sensorCol, sensorRow, READ_Y);
+    }
+
+    currentCalibratedX = calculateCalibratedX(currentRawX);
+
     // if this is the first X read for this touch...
     if (initialX == INVALID_DATA) {
       // store the calibrated X reference that corresponds to the cell's note without any pitch bend
@@ -389,7 +476,9 @@ unsigned short TouchInfo::rawY() {
 
 inline void TouchInfo::refreshY() {
   if (shouldRefreshY) {
+    unsigned long profileStart = beginProfile();
     currentRawY = readY(percentRawZ);
+    endProfile(profileReadY, profileStart);
     currentCalibratedY = calculateCalibratedY(currentRawY);
     shouldRefreshY = false;
 
@@ -459,12 +548,47 @@ inline unsigned short calculatePreferredPressureRange(unsigned short sensorRange
     return sensorRangePressure;
 }
 
+void applySensorRangesZ() {
+  sensorRangesZ.sensorRange = calculateSensorRangeZ();
+
+  unsigned short sensorRangeVelocity = sensorRangesZ.sensorRange;
+  switch (Global.velocitySensitivity) {
+    case velocityHigh:
+      sensorRangeVelocity -= 254;
+      break;
+    case velocityMedium:
+      sensorRangeVelocity -= 63;
+      break;
+    case velocityLow:
+      sensorRangeVelocity += 127;
+      break;
+    case velocityFixed:
+      // no change
+      break;
+  }
+
+  unsigned short sensorRangePressure = calculatePreferredPressureRange(sensorRangesZ.sensorRange);
+  short pressureOffset = 0;
+  if (Global.pressureAftertouch) {
+    sensorRangePressure /= 5;
+    pressureOffset = sensorRangeVelocity - sensorRangePressure;
+  }
+
+  sensorRangesZ.velocityRange = sensorRangeVelocity;
+  sensorRangesZ.pressureRange = sensorRangePressure;
+  sensorRangesZ.pressureOffset = pressureOffset;
+  sensorRangesZ.fxdVelocityRatio = FXD_DIV(FXD_FROM_INT(MAX_SENSOR_RANGE_Z), FXD_FROM_INT(sensorRangeVelocity));
+  sensorRangesZ.fxdPressureRatio = FXD_DIV(FXD_FROM_INT(MAX_SENSOR_RANGE_Z), FXD_FROM_INT(sensorRangePressure));
+}
+
 inline void TouchInfo::refreshZ() {
   if (shouldRefreshZ) {
     // store the raw Z data for later comparisons and calculations
     unsigned short previousPreviousRawZ = previousRawZ;
     previousRawZ = currentRawZ;
+    unsigned long profileStart = beginProfile();
     currentRawZ = readZ();
+    endProfile(profileReadZ, profileStart);
     featherTouch = false;
     velocityZ = 0;
     pressureZ = 0;
@@ -515,40 +639,24 @@ inline void TouchInfo::refreshZ() {
       return;
     }
 
-    // calculate the velocity and pressure for the playing cells
-    unsigned short sensorRange = calculateSensorRangeZ();
-
-    unsigned short sensorRangeVelocity = sensorRange;
-    switch (Global.velocitySensitivity) {
-      case velocityHigh:
-        sensorRangeVelocity -= 254;
-        break;
-      case velocityMedium:
-        sensorRangeVelocity -= 63;
-        break;
-      case velocityLow:
-        sensorRangeVelocity += 127;
-        break;
-      case velocityFixed:
-        // no change
-        break;
-    }
-
-    unsigned short sensorRangePressure = calculatePreferredPressureRange(sensorRange);
-
-    unsigned short usableVelocityZ = constrain(usableZ, 1, sensorRangeVelocity);
+    // calculate the velocity and pressure for the playing cells, the ranges are derived from the settings by applySensorRangesZ()
+    unsigned short usableVelocityZ = constrain(usableZ, 1, sensorRangesZ.velocityRange);
     unsigned short usablePressureZ;
     if (Global.pressureAftertouch) {
-      sensorRangePressure /= 5;
-      usablePressureZ = constrain(usableZ - (sensorRangeVelocity - sensorRangePressure), 0, sensorRangePressure);
+      usablePressureZ = constrain(usableZ - sensorRangesZ.pressureOffset, 0, sensorRangesZ.pressureRange);
     }
     else {
-      usablePressureZ = constrain(usableZ, 1, sensorRangePressure);
+      usablePressureZ = constrain(usableZ, 1, sensorRangesZ.pressureRange);
+    }
+    percentRawZ = (constrain(usableZ, 0, sensorRangesZ.sensorRange) * 100) / sensorRangesZ.sensorRange;
+
+    // start settling the analog switches for the X read of this touch while Z is being processed
+    if (shouldRefreshX) {
+      prepareSensorCell(sensorCol, sensorRow, READ_X);
     }
-    percentRawZ = (constrain(usableZ, 0, sensorRange) * 100) / sensorRange;
 
-    int32_t fxd_usableVelocityZ = FXD_MUL(FXD_FROM_INT(usableVelocityZ), FXD_DIV(FXD_FROM_INT(MAX_SENSOR_RANGE_Z), FXD_FROM_INT(sensorRangeVelocity)));
-    int32_t fxd_usablePressureZ = FXD_MUL(FXD_FROM_INT(usablePressureZ), FXD_DIV(FXD_FROM_INT(MAX_SENSOR_RANGE_Z), FXD_FROM_INT(sensorRangePressure)));
+    int32_t fxd_usableVelocityZ = FXD_MUL(FXD_FROM_INT(usableVelocityZ), sensorRangesZ.fxdVelocityRatio);
+    int32_t fxd_usablePressureZ = FXD_MUL(FXD_FROM_INT(usablePressureZ), sensorRangesZ.fxdPressureRatio);
 
     // apply the sensitivity curve
     usableVelocityZ = FXD_TO_INT(fxd_usableVelocityZ);